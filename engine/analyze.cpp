@@ -0,0 +1,186 @@
+#include "analyze.h"
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+// ========================================================================
+//  Input
+// ========================================================================
+bool parsePositionLine(Board& b, const std::string& line) {
+    std::istringstream iss(line);
+    std::string token;
+    if (!(iss >> token)) return false;
+    if (token == "position" && !(iss >> token)) return false;
+
+    if (token == "startpos") {
+        b.init();
+        iss >> token;
+    } else if (token == "fen" || token.find('/') != std::string::npos) {
+        std::string fen = token == "fen" ? "" : token;
+        while (iss >> token) {
+            if (token == "moves") break;
+            if (!fen.empty()) fen += ' ';
+            fen += token;
+        }
+        if (!b.setFEN(fen)) return false;
+    } else {
+        // Bare move list from the start position
+        b.init();
+        Move m = strToMove(token);
+        if (m == MOVE_NONE || !b.isLegal(m)) return false;
+        b.makeMove(m);
+        token = "moves";
+    }
+
+    if (token == "moves") {
+        while (iss >> token) {
+            Move m = strToMove(token);
+            if (m == MOVE_NONE || !b.isLegal(m)) return false;
+            b.makeMove(m);
+        }
+    }
+    return true;
+}
+
+// ========================================================================
+//  Output
+// ========================================================================
+static std::string formatScore(int score) {
+    char buf[32];
+    if (abs(score) >= SCORE_MATE - MAX_PLY) {
+        int mateIn = (SCORE_MATE - abs(score) + 1) / 2;
+        std::snprintf(buf, sizeof(buf), "mate %s%d", score > 0 ? "" : "-", mateIn);
+    } else {
+        std::snprintf(buf, sizeof(buf), "cp %d", score);
+    }
+    return buf;
+}
+
+static std::string analyzeOne(int slot, const std::string& line, const AnalyzeSearchFn& search,
+                              bool& failed) {
+    Board b;
+    if (!parsePositionLine(b, line)) return line + ", error";
+
+    std::string out = b.toFEN() + ", ";
+    Move moves[MAX_MOVES];
+    int count = 0;
+    b.generateMoves(moves, count);
+    int over = b.checkGameOver();
+    if (over != 0 || count == 0)
+        return out + "none, " + (over > 0 ? "win" : "loss") + ",";   // no moves = loss
+
+    Move best;
+    RootLine pv;
+    if (!search(slot, b, best, pv)) { failed = true; return ""; }
+    out += moveToStr(best) + ", " + formatScore(pv.score) + ",";
+    for (int i = 0; i < pv.len; i++) out += " " + moveToStr(pv.pv[i]);
+    return out;
+}
+
+// ========================================================================
+//  Job loop
+// ========================================================================
+// Slots take the next input line under the lock, so the input is read
+// as a stream; finished results wait in `pending` until every earlier
+// line has been written. A line whose searcher failed goes back to
+// `retry` for the other slots; the failed slot stops.
+int runAnalyzeJobs(std::istream& in, const AnalyzeOptions& opt, int slots,
+                   const AnalyzeSearchFn& search, const std::string& label) {
+    std::mutex mtx;
+    int nextIn = 0, nextOut = 0;
+    bool eof = false;
+    std::map<int, std::string> pending;
+    std::vector<std::pair<int, std::string>> retry;
+    auto t0 = std::chrono::steady_clock::now();
+
+    auto flush = [&]() {
+        for (auto it = pending.find(nextOut); it != pending.end(); it = pending.find(nextOut)) {
+            std::printf("%s\n", it->second.c_str());
+            pending.erase(it);
+            nextOut++;
+        }
+        fflush(stdout);
+    };
+
+    auto worker = [&](int slot) {
+        for (;;) {
+            std::string line;
+            int idx;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!retry.empty()) {
+                    idx  = retry.back().first;
+                    line = retry.back().second;
+                    retry.pop_back();
+                } else {
+                    for (;;) {
+                        if (eof || !std::getline(in, line)) { eof = true; return; }
+                        size_t p = line.find_first_not_of(" \t\r");
+                        if (p == std::string::npos || line[p] == '#') continue;
+                        size_t e = line.find_last_not_of(" \t\r");
+                        line = line.substr(p, e - p + 1);
+                        break;
+                    }
+                    idx = nextIn++;
+                }
+            }
+
+            bool failed = false;
+            std::string result = analyzeOne(slot, line, search, failed);
+
+            std::lock_guard<std::mutex> lock(mtx);
+            if (failed) { retry.emplace_back(idx, line); return; }
+            pending[idx] = result;
+            flush();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < slots; i++) workers.emplace_back(worker, i);
+    worker(0);
+    for (auto& w : workers) w.join();
+
+    // Every searcher failed: the lines still held cannot be answered
+    for (auto& r : retry) pending[r.first] = r.second + ", error";
+    flush();
+
+    auto t1 = std::chrono::steady_clock::now();
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::fprintf(stderr, "analyzed %d positions at depth %d in %lld ms (%s)\n",
+                 nextOut, opt.depth, (long long)ms, label.c_str());
+    return nextOut;
+}
+
+// ========================================================================
+//  Local searchers
+// ========================================================================
+int runAnalyze(std::istream& in, const AnalyzeOptions& opt) {
+    int threads = std::max(1, opt.threads);
+
+    // Set up the searchers here: Search::init touches shared tables
+    std::vector<std::unique_ptr<Search>> pool;
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back(new Search());
+        pool.back()->init(opt.hashMB);
+        pool.back()->silent = true;
+    }
+
+    // Fresh table and history per line: results do not depend on which
+    // searcher had which earlier lines, so any thread count gives the
+    // same output
+    AnalyzeSearchFn search = [&](int slot, const Board& b, Move& best, RootLine& line) {
+        Search& s = *pool[slot];
+        s.newGame();
+        s.board = b;
+        SearchLimits limits;
+        limits.depth = opt.depth;
+        best = s.think(limits);
+        line = s.bestLine();
+        return true;
+    };
+    int n = runAnalyzeJobs(in, opt, threads, search, std::to_string(threads) + " threads");
+    for (auto& s : pool) s->destroy();
+    return n;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "search.h"
+#include <functional>
+#include <istream>
+
+// ---- Batch analysis ----
+// Reads one position per line and searches each to a fixed depth on a pool
+// of independent searchers (one Search, TT and thread each), writing
+//   <fen>, <bestmove>, <score>, <pv>
+// in input order. Each position starts from a cleared table and history,
+// so the output does not depend on the thread count. A line is a FEN, "startpos [moves ...]", "fen <fen>
+// [moves ...]" (an optional leading "position" is ignored), or a bare
+// move list played from the start position. Blank lines and lines
+// starting with '#' are skipped; unreadable lines are answered with
+// "<line>, error". A finished game gives "<fen>, none, win|loss,".
+struct AnalyzeOptions {
+    int    depth   = 10;
+    int    threads = 1;       // searchers, each single-threaded
+    size_t hashMB  = 16;      // per searcher
+};
+
+// Returns the number of positions analysed
+int runAnalyze(std::istream& in, const AnalyzeOptions& opt);
+
+// Searches a set-up position on searcher `slot` to opt.depth: best move and
+// line. False if the searcher is gone (the line moves to another slot).
+using AnalyzeSearchFn = std::function<bool(int slot, const Board& b, Move& best, RootLine& line)>;
+
+// The input and output loop of runAnalyze over `slots` searchers, one
+// thread each; `label` describes them in the summary ("8 threads")
+int runAnalyzeJobs(std::istream& in, const AnalyzeOptions& opt, int slots,
+                   const AnalyzeSearchFn& search, const std::string& label);
+
+// Sets up `b` from one input line as described above; false if unreadable
+bool parsePositionLine(Board& b, const std::string& line);
@@ -0,0 +1,114 @@
+#include "bench.h"
+#include <cstdio>
+
+// ========================================================================
+//  Positions
+// ========================================================================
+static const char* BENCH_FENS[] = {
+    // Opening
+    "l5t/1d3c1/r1p1w1e/7/7/7/E1W1P1R/1C3D1/T5L w",
+    "l5t/1d4c/r1p1w1e/7/7/6R/E1W1P2/5D1/TC4L b",
+    "l5t/4wc1/rdp4/6e/7/7/2W2PR/E4D1/TC4L w",
+    "l5t/1d3c1/2p1w1e/r6/7/7/E4PR/TCW2D1/6L w",
+    "l3t2/1d3c1/r2pw1e/7/7/E6/4P1R/1CW2DL/T6 w",
+    "l6/1d1c2t/r2pwe1/7/7/E6/2W1P1R/C4D1/T4L1 w",
+    "l6/2d2ct/1rp1w1e/7/7/6R/EW2P2/1C3D1/1T4L w",
+    "l1p3t/1d3c1/r3w1e/7/7/E2W3/5PR/1C4D/T5L b",
+    "l4t1/4w1c/rdp3e/7/7/7/E2WP1R/7/T1C1D1L b",
+    "l5t/1d3c1/2p1weR/7/7/7/rE1WP2/1C3D1/T5L b",
+    // Midgame
+    "7/l2r1t1/2w2T1/5R1/3p3/7/E5D/5P1/4L2 w",
+    "l3tc1/1dp4/1w2e2/7/7/7/T4D1/1W1L2R/1CP4 b",
+    "7/1p5/lr3c1/3P2e/7/7/5D1/1EC4/1T5 w",
+    "ldp4/7/r2L3/7/3P3/7/2R3e/4W2/TC2D2 b",
+    "d6/lct3R/3w1L1/7/T6/7/4D2/1C5/1W2P2 b",
+    "1d2wt1/2p2ce/r6/7/7/6P/7/1T1WRDL/1C5 w",
+    "1rl3t/2d1c2/2p4/7/7/E6/5W1/T3LD1/2C3P w",
+    "4t2/l3c2/4w2/1r5/7/E6/3L3/1TP3D/7 b",
+    "2c4/4p2/r4t1/3w3/6e/7/1l3R1/7/6L b",
+    "r1l4/6t/2de3/7/E2w3/6R/1W5/2CD3/1T3P1 w",
+    "2l4/1p4c/dr4t/7/C2P3/7/3D1L1/1E5/2T4 w",
+    "4t2/2dc3/l1p3w/7/7/r5R/1C5/1T5/1W2PL1 w",
+    "7/3d3/2c1e2/7/1R1L1r1/7/2T1l2/3E3/7 w",
+    "3w3/2drc2/7/7/7/7/7/2DRC2/3W3 w",
+    // Rat next to the enemy elephant
+    "l1d3t/5c1/2p2e1/r2w2R/7/7/2W1P2/CE3D1/T5L w",
+    "lp4e/5c1/3dwt1/r6/7/E6/C3D2/2P2L1/TW4R b",
+    "5w1/d2lt2/7/p6/7/7/4D1e/ET5/4CLR b",
+    "1l2c1t/1pd1w2/7/6e/1r5/E6/4P2/TCW3R/4DL1 w",
+    "ld5/r6/3L3/7/7/5Re/7/E5D/TWC1P2 w",
+    "7/r3dwt/1p4c/7/E6/4R1e/7/7/1l4P b",
+    // Close to the den
+    "1l2t2/1rd2c1/5e1/3w3/7/7/E2p3/TW3R1/C3PL1 b",
+    "4c2/2T3t/5e1/6l/7/7/7/1E5/1CW2D1 w",
+    "2r1p2/1ld3e/7/7/7/7/6R/1T2w1P/E6 b",
+    "7/l1T4/4c2/6t/L6/7/E6/2CD3/6P w",
+    "l5t/2Tc3/3w1p1/7/1r5/7/E2WP2/6D/2C3L w",
+    "1dl4/3P2t/2R4/p6/E6/7/T6/2e4/1WC4 b",
+    "7/2l3L/p6/7/7/4R2/2Cd3/T1W1P2/4D2 b",
+    "1l3w1/r1d4/1p2c1e/7/7/7/3t3/1C2L2/E1T2PD b",
+    "2e1t2/3r3/7/L6/4R2/6T/1l5/3C3/2E4 b",
+    // Sparse endgames
+    "5L1/7/7/W6/E5l/7/T6/7/C6 w",
+    "r6/p3cL1/5d1/7/7/6w/7/7/7 b",
+    "7/7/7/C6/6t/7/T2P2D/7/1E5 b",
+    "7/3d2c/7/3w3/7/l6/5Te/7/7 w",
+    "7/d6/2p2L1/r6/7/7/4T2/2E4/7 b",
+    "7/e6/6c/7/7/7/T6/1W4R/4C2 b",
+    "7/7/1e5/7/3T3/7/5C1/4D2/1E4R w",
+    "7/6e/1l5/r6/7/7/2L4/P6/C6 w",
+    "6w/7/5c1/6t/7/6e/7/2l4/6L b",
+    "l6/2p4/5c1/7/7/7/7/4W2/1LT4 w",
+    "4t2/4c2/5e1/7/7/6R/7/3C3/7 w",
+    "4e2/7/7/7/7/5R1/2l3L/4P2/7 b",
+    "3l3/7/7/1r1L3/7/7/3T3/7/t6 w",
+};
+
+// ========================================================================
+//  Run
+// ========================================================================
+void runBench(Search& engine, int depth, int threads, size_t hashMB) {
+    Board  saved       = engine.board;
+    size_t savedHash   = engine.hashMB();
+    int    savedThreads = engine.threadCount();
+
+    engine.resizeTT(hashMB);
+    engine.setThreads(threads);
+    engine.silent = true;
+
+    const int n = (int)(sizeof(BENCH_FENS) / sizeof(BENCH_FENS[0]));
+    int64_t  totalNodes = 0;
+    uint64_t signature  = 0xCBF29CE484222325ULL;   // FNV-1a over node counts
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < n; i++) {
+        engine.newGame();
+        engine.board.setFEN(BENCH_FENS[i]);
+        SearchLimits limits;
+        limits.depth = depth;
+        Move best = engine.think(limits);
+        int64_t nodes = engine.totalNodes();
+        totalNodes += nodes;
+        signature = (signature ^ (uint64_t)nodes) * 0x100000001B3ULL;
+        std::printf("bench %2d/%d  %-44s  %s  %lld nodes\n", i + 1, n, BENCH_FENS[i],
+                    moveToStr(best).c_str(), (long long)nodes);
+        fflush(stdout);
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::printf("\nDepth           : %d\n", depth);
+    std::printf("Threads         : %d\n", threads);
+    std::printf("Hash (MB)       : %zu\n", hashMB);
+    std::printf("Total time (ms) : %lld\n", (long long)ms);
+    std::printf("Nodes searched  : %lld\n", (long long)totalNodes);
+    std::printf("Nodes/second    : %lld\n", (long long)(totalNodes * 1000 / std::max<int64_t>(ms, 1)));
+    std::printf("Signature       : %016llx\n", (unsigned long long)signature);
+    fflush(stdout);
+
+    engine.silent = false;
+    engine.setThreads(savedThreads);
+    engine.resizeTT(savedHash);
+    engine.newGame();
+    engine.board = saved;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "search.h"
+
+// ---- Benchmark ----
+// Searches a fixed set of positions to `depth` with a fresh table and
+// history for each, then prints total nodes, time, nps and a signature of
+// the per-position node counts. The signature changes with any functional
+// change to search or move ordering; it is reproducible with 1 thread
+// only. The engine's board, Hash and Threads settings are restored after.
+constexpr int BENCH_DEPTH   = 8;
+constexpr int BENCH_THREADS = 1;
+constexpr int BENCH_HASH    = 16;
+
+void runBench(Search& engine, int depth, int threads, size_t hashMB);
@@ -1,195 +1,166 @@
 #include "board.h"
-#include <queue>
+#include "evalweights.h"
+#include "tables.h"
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <sstream>
 #include <cctype>
+#include <cassert>
+
+// ---- Cuckoo tables ----
+// Reversible moves keyed by the hash difference of a quiet move (both
+// piece keys and the side key), two slots per key. Every rank/colour/square
+// pair a quiet move can cross in both directions: steps (water for the rat
+// only) and lion/tiger river jumps. Dens are left out: the own den is never
+// entered, the enemy den ends the game.
+constexpr int CUCKOO_SIZE = 8192;
+constexpr int cuckooH1(uint64_t key) { return (int)(key & (CUCKOO_SIZE - 1)); }
+constexpr int cuckooH2(uint64_t key) { return (int)((key >> 16) & (CUCKOO_SIZE - 1)); }
+
+struct CuckooTables {
+    uint64_t key[CUCKOO_SIZE];
+    Move     move[CUCKOO_SIZE];
+};
+
+static constexpr CuckooTables makeCuckooTables() {
+    CuckooTables t{};
+    for (int i = 0; i < CUCKOO_SIZE; i++) t.move[i] = MOVE_NONE;
+    for (int c = 0; c < 2; c++)
+        for (int rk = 1; rk < NUM_PIECE_TYPES; rk++)
+            for (int s1 = 0; s1 < NUM_SQ; s1++) {
+                if (terrain[s1] == TERRAIN_DEN_LIGHT || terrain[s1] == TERRAIN_DEN_DARK) continue;
+                if (isWater[s1] && rk != RAT) continue;
+                Bitboard dests = stepBB[s1] & ~denBB[LIGHT] & ~denBB[DARK];
+                if (rk != RAT) dests &= ~waterBB;
+                if (rk == LION || rk == TIGER)
+                    for (int i = 0; i < sqJumpLookup[s1].count; i++) dests |= sqBB(sqJumpLookup[s1].dest[i]);
+                while (dests) {
+                    int s2 = popLSB(dests);
+                    if (s2 < s1) continue;
+                    Move m = encodeMove(s1, s2);
+                    uint64_t key = zobristPiece[s1][rk][c] ^ zobristPiece[s2][rk][c] ^ zobristSide;
+                    int i = cuckooH1(key);
+                    for (;;) {
+                        uint64_t k = t.key[i]; t.key[i] = key; key = k;
+                        Move mv = t.move[i]; t.move[i] = m; m = mv;
+                        if (m == MOVE_NONE) break;
+                        i = (i == cuckooH1(key)) ? cuckooH2(key) : cuckooH1(key);
+                    }
+                }
+            }
+    return t;
+}
 
-// ---- Global table storage ----
-int  terrain[NUM_SQ];
-bool isWater[NUM_SQ];
-int  distLand[2][NUM_SQ];
-int  distJumper[2][NUM_SQ];
-int  distSwimmer[2][NUM_SQ];
-
-JumpEntry jumpTable[MAX_JUMPS];
-int numJumps = 0;
-SqJumps sqJumpLookup[NUM_SQ];
-
-uint64_t zobristPiece[NUM_SQ][NUM_PIECE_TYPES][2];
-uint64_t zobristSide;
-
-// ---- Piece-square tables (from Light's perspective, row 0 = Light's back rank) ----
-// Index: [rank][sq]  (rank 0 unused)
-static int PST[NUM_PIECE_TYPES][NUM_SQ];
-
-// Base advancement + center values per square (Light perspective)
-static int basePST[NUM_SQ];
-
-// Distance tables for evaluation
-static void computeBFS(int denSq, int type, int* dist);
+static constexpr CuckooTables CUCKOO = makeCuckooTables();
 
 // ========================================================================
-//  initTables() - call once at startup
+//  Eval parameters
 // ========================================================================
-void initTables() {
-    // ---- Terrain ----
-    memset(terrain, TERRAIN_LAND, sizeof(terrain));
-    memset(isWater, 0, sizeof(isWater));
-
-    // Water squares
-    int waterSqs[] = {22,23,29,30,36,37, 25,26,32,33,39,40};
-    for (int sq : waterSqs) { terrain[sq] = TERRAIN_WATER; isWater[sq] = true; }
-
-    // Dens
-    terrain[DEN_LIGHT_SQ] = TERRAIN_DEN_LIGHT;
-    terrain[DEN_DARK_SQ]  = TERRAIN_DEN_DARK;
-
-    // Traps
-    int lightTraps[] = { makeSq(0,2), makeSq(0,4), makeSq(1,3) }; // C1, E1, D2
-    int darkTraps[]  = { makeSq(8,2), makeSq(8,4), makeSq(7,3) }; // C9, E9, D8
-    for (int sq : lightTraps) terrain[sq] = TERRAIN_TRAP_LIGHT;
-    for (int sq : darkTraps)  terrain[sq] = TERRAIN_TRAP_DARK;
-
-    // ---- Jump table ----
-    numJumps = 0;
-    memset(sqJumpLookup, 0, sizeof(sqJumpLookup));
-
-    auto addJump = [&](int from, int to, std::initializer_list<int> blocks) {
-        JumpEntry& e = jumpTable[numJumps++];
-        e.from = from; e.to = to;
-        e.numBlocking = 0;
-        for (int b : blocks) e.blocking[e.numBlocking++] = b;
-    };
-
-    // Left river horizontal jumps (cols B-C = 1,2;  rows 4-6 = index 3-5)
-    for (int r = 3; r <= 5; r++) {
-        int a = makeSq(r,0), b1 = makeSq(r,1), b2 = makeSq(r,2), d = makeSq(r,3);
-        addJump(a, d, {b1, b2});   // A->D east
-        addJump(d, a, {b2, b1});   // D->A west
-    }
-    // Right river horizontal jumps (cols E-F = 4,5;  rows 4-6)
-    for (int r = 3; r <= 5; r++) {
-        int d = makeSq(r,3), e1 = makeSq(r,4), e2 = makeSq(r,5), g = makeSq(r,6);
-        addJump(d, g, {e1, e2});   // D->G east
-        addJump(g, d, {e2, e1});   // G->D west
-    }
-    // Left river vertical jumps (cols B,C; rows 3->7 over rows 4,5,6)
-    for (int c = 1; c <= 2; c++) {
-        int bot = makeSq(2,c), top = makeSq(6,c);
-        int w1 = makeSq(3,c), w2 = makeSq(4,c), w3 = makeSq(5,c);
-        addJump(bot, top, {w1, w2, w3}); // row3 -> row7 north
-        addJump(top, bot, {w3, w2, w1}); // row7 -> row3 south
-    }
-    // Right river vertical jumps (cols E,F)
-    for (int c = 4; c <= 5; c++) {
-        int bot = makeSq(2,c), top = makeSq(6,c);
-        int w1 = makeSq(3,c), w2 = makeSq(4,c), w3 = makeSq(5,c);
-        addJump(bot, top, {w1, w2, w3});
-        addJump(top, bot, {w3, w2, w1});
-    }
-
-    // Build per-square jump lookup
-    for (int i = 0; i < numJumps; i++) {
-        const JumpEntry& e = jumpTable[i];
-        SqJumps& sj = sqJumpLookup[e.from];
-        int idx = sj.count;
-        sj.dest[idx] = e.to;
-        sj.blockStart[idx] = (idx > 0) ? sj.blockStart[idx-1] + sj.blockCount[idx-1] : 0;
-        sj.blockCount[idx] = e.numBlocking;
-        for (int j = 0; j < e.numBlocking; j++)
-            sj.blockingSqs[sj.blockStart[idx] + j] = e.blocking[j];
-        sj.count++;
-    }
+const EvalParamGroup EVAL_PARAM_GROUPS[] = {
+    { "material",     EP_MATERIAL,      9 },
+    { "row",          EP_ROW,           9 },
+    { "col",          EP_COL,           7 },
+    { "ratWater",     EP_RAT_WATER,     9 },
+    { "jumpSquare",   EP_JUMP_SQUARE,   1 },
+    { "denProximity", EP_DEN_PROXIMITY, 9 },
+    { "denNear",      EP_DEN_NEAR,      4 },
+    { "egDen",        EP_EG_DEN,        4 },
+    { "trap",         EP_TRAP,          9 },
+    { "ratThreat",    EP_RAT_THREAT,    3 },
+    { "ratDanger",    EP_RAT_DANGER,    3 },
+    { "denSafety",    EP_DEN_SAFETY,    3 },
+    { "pieceCount",   EP_PIECE_COUNT,   1 },
+};
+const int NUM_EVAL_PARAM_GROUPS = (int)(sizeof(EVAL_PARAM_GROUPS) / sizeof(EVAL_PARAM_GROUPS[0]));
+
+// Distance of a piece to the den it attacks, by how it moves
+static constexpr int denDistance(int color, int rk, int sq) {
+    int targetDen = (color == LIGHT) ? 1 : 0;
+    if (rk == RAT) return distSwimmer[targetDen][sq];
+    if (rk == LION || rk == TIGER) return distJumper[targetDen][sq];
+    return distLand[targetDen][sq];
+}
 
-    // ---- Zobrist keys ----
-    std::mt19937_64 rng(0xDEADBEEF42ULL);
-    for (int sq = 0; sq < NUM_SQ; sq++)
-        for (int rk = 1; rk < NUM_PIECE_TYPES; rk++)
-            for (int c = 0; c < 2; c++)
-                zobristPiece[sq][rk][c] = rng();
-    zobristSide = rng();
-
-    // ---- BFS distance tables ----
-    // type 0 = land-only, type 1 = jumper (land + jumps), type 2 = swimmer (land + water)
-    for (int den = 0; den < 2; den++) {
-        int denSq = (den == 0) ? DEN_LIGHT_SQ : DEN_DARK_SQ;
-        computeBFS(denSq, 0, distLand[den]);
-        computeBFS(denSq, 1, distJumper[den]);
-        computeBFS(denSq, 2, distSwimmer[den]);
-    }
+// Terms of psqValue[color][rk][sq]: material + PST + den proximity,
+// reported as add(parameter, coefficient). The PST is from Light's side.
+template <typename Add>
+static constexpr void psqTerms(int color, int rk, int sq, Add&& add) {
+    add(EP_MATERIAL + rk, 1);
 
-    // ---- Piece-square tables ----
-    // Base PST: advancement + center gradient (from Light perspective)
-    const int rowBonus[9]  = { -5, 0, 5, 15, 25, 35, 55, 85, 120 };
-    const int colBonus[7]  = { 0, 5, 15, 30, 15, 5, 0 };
+    int pstSq = (color == LIGHT) ? sq : (NUM_SQ - 1 - sq);
+    if (isWater[pstSq]) {
+        if (rk == RAT) add(EP_RAT_WATER + sqRow(pstSq), 1);
+    } else {
+        add(EP_ROW + sqRow(pstSq), 1);
+        add(EP_COL + sqCol(pstSq), 1);
+        int dd = distLand[1][pstSq];            // to the dark den (for Light)
+        if (dd <= 8) add(EP_DEN_PROXIMITY + dd, 1);
+    }
+    // River jumps starting on this square
+    if ((rk == LION || rk == TIGER) && sqJumpLookup[pstSq].count)
+        add(EP_JUMP_SQUARE, sqJumpLookup[pstSq].count);
+
+    int d = denDistance(color, rk, sq);
+    if (d <= 1)      add(EP_DEN_NEAR + 0, 1);
+    else if (d == 2) add(EP_DEN_NEAR + 1, 1);
+    else if (d == 3) add(EP_DEN_NEAR + 2, 1);
+    else if (d <= 5) add(EP_DEN_NEAR + 3, 1);
+}
 
-    for (int sq = 0; sq < NUM_SQ; sq++) {
-        if (isWater[sq]) { basePST[sq] = 0; continue; }
-        int r = sqRow(sq), c = sqCol(sq);
-        basePST[sq] = rowBonus[r] + colBonus[c];
-    }
+// Terms of egDenValue[color][rk][sq]
+template <typename Add>
+static constexpr void egDenTerms(int color, int rk, int sq, Add&& add) {
+    int d = denDistance(color, rk, sq);
+    if (d <= 3) add(EP_EG_DEN + d, 1);
+}
 
-    // Per-piece PSTs  (adjustments on top of base)
-    for (int sq = 0; sq < NUM_SQ; sq++) {
+// The weights with the per-piece incremental eval values built from them,
+// oriented per colour: psqValue = material + PST + den proximity,
+// egDenValue = endgame den race
+struct EvalTables {
+    int params[NUM_EVAL_PARAMS];
+    int psqValue[2][NUM_PIECE_TYPES][NUM_SQ];
+    int egDenValue[2][NUM_PIECE_TYPES][NUM_SQ];
+};
+
+static constexpr EvalTables makeEvalTables(const int* params) {
+    EvalTables t{};
+    for (int i = 0; i < NUM_EVAL_PARAMS; i++) t.params[i] = params[i];
+    for (int color = 0; color < 2; color++) {
         for (int rk = 1; rk <= 8; rk++) {
-            PST[rk][sq] = basePST[sq];
+            for (int sq = 0; sq < NUM_SQ; sq++) {
+                int v = 0, eg = 0;
+                psqTerms(color, rk, sq, [&](int i, int c) { v += c * params[i]; });
+                egDenTerms(color, rk, sq, [&](int i, int c) { eg += c * params[i]; });
+                t.psqValue[color][rk][sq]   = v;
+                t.egDenValue[color][rk][sq] = eg;
+            }
         }
     }
+    return t;
+}
 
-    // Rats get bonus for water squares and advanced positions
-    for (int sq = 0; sq < NUM_SQ; sq++) {
-        if (isWater[sq]) PST[RAT][sq] = 20 + sqRow(sq) * 5;
-    }
-
-    // Lions/tigers get extra bonus for river-adjacent squares (can jump)
-    for (int i = 0; i < numJumps; i++) {
-        PST[LION][jumpTable[i].from]  += 15;
-        PST[TIGER][jumpTable[i].from] += 15;
-    }
+// The defaults are built by the compiler; setEvalParams replaces them
+static constexpr EvalTables DEFAULT_EVAL_TABLES = makeEvalTables(DEFAULT_EVAL_PARAMS);
+static EvalTables evalTables = DEFAULT_EVAL_TABLES;
+static auto& psqValue   = evalTables.psqValue;
+static auto& egDenValue = evalTables.egDenValue;
+int (&evalParams)[NUM_EVAL_PARAMS] = evalTables.params;
 
-    // Emphasise den-proximity for all pieces (beyond the row bonus)
-    for (int sq = 0; sq < NUM_SQ; sq++) {
-        if (isWater[sq]) continue;
-        int dd = distLand[1][sq]; // distance to dark den (for Light)
-        if (dd <= 8) {
-            int bonus = std::max(0, 130 - dd * 15);
-            for (int rk = 1; rk <= 8; rk++)
-                PST[rk][sq] += bonus;
-        }
-    }
+void setEvalParams(const int* params) {
+    evalTables = makeEvalTables(params);
 }
 
-// BFS distance computation
-static void computeBFS(int denSq, int type, int* dist) {
-    for (int i = 0; i < NUM_SQ; i++) dist[i] = 99;
-    std::queue<int> q;
-    dist[denSq] = 0;
-    q.push(denSq);
-
-    while (!q.empty()) {
-        int sq = q.front(); q.pop();
-        int nd = dist[sq] + 1;
-
-        // Normal 4-directional moves
-        for (int d : DIRS) {
-            if (!canStep(sq, d)) continue;
-            int ns = sq + d;
-            if (type == 0 && isWater[ns]) continue;         // land-only
-            if (type == 1 && isWater[ns]) continue;         // jumper: land only for steps
-            // type 2 (swimmer): can traverse water
-            if (nd < dist[ns]) { dist[ns] = nd; q.push(ns); }
-        }
-
-        // Jumps (type 1 = jumper)
-        if (type == 1) {
-            const SqJumps& sj = sqJumpLookup[sq];
-            for (int i = 0; i < sj.count; i++) {
-                int ns = sj.dest[i];
-                if (nd < dist[ns]) { dist[ns] = nd; q.push(ns); }
-            }
-        }
-    }
+Board& Board::operator=(const Board& o) {
+    if (this == &o) return *this;
+    static_cast<BoardState&>(*this) = o;
+    ply = o.ply;
+    histLen = o.histLen;
+    acc = o.acc;
+    std::copy(o.undoStack, o.undoStack + ply, undoStack);
+    std::copy(o.posHistory, o.posHistory + histLen, posHistory);
+    return *this;
 }
 
 // ========================================================================
@@ -200,15 +171,18 @@ void Board::init() {
     memset(pieceSq, -1, sizeof(pieceSq));
     pieceCount[LIGHT] = 8;
     pieceCount[DARK]  = 8;
+    occ[LIGHT] = occ[DARK] = 0;
     sideToMove = LIGHT;
     ply = 0;
     halfmove = 0;
+    pliesFromNull = 0;
     histLen = 0;
 
     // Light pieces (positive)
     auto place = [&](int color, int rank, int sq) {
         squares[sq] = (int8_t)(color == LIGHT ? rank : -rank);
         pieceSq[color][rank] = (int8_t)sq;
+        occ[color] |= sqBB(sq);
     };
 
     // Bottom player (Light) - rows 1-3
@@ -232,6 +206,8 @@ void Board::init() {
     place(DARK, RAT,      makeSq(6,0)); // A7
 
     computeHash();
+    computeEvalSums(psq, egDen);
+    refreshAccumulator();
     posHistory[histLen++] = hash;
 }
 
@@ -246,8 +222,10 @@ bool Board::setFEN(const std::string& fen) {
     memset(pieceSq, -1, sizeof(pieceSq));
     pieceCount[LIGHT] = 0;
     pieceCount[DARK]  = 0;
+    occ[LIGHT] = occ[DARK] = 0;
     ply = 0;
     halfmove = 0;
+    pliesFromNull = 0;
     histLen = 0;
 
     size_t idx = 0;
@@ -267,6 +245,7 @@ bool Board::setFEN(const std::string& fen) {
         squares[sq] = (int8_t)(color == LIGHT ? rk : -rk);
         pieceSq[color][rk] = (int8_t)sq;
         pieceCount[color]++;
+        occ[color] |= sqBB(sq);
         col++;
     }
 
@@ -279,6 +258,8 @@ bool Board::setFEN(const std::string& fen) {
     }
 
     computeHash();
+    computeEvalSums(psq, egDen);
+    refreshAccumulator();
     posHistory[histLen++] = hash;
     return true;
 }
@@ -318,6 +299,22 @@ void Board::computeHash() {
     if (sideToMove == DARK) hash ^= zobristSide;
 }
 
+void Board::computeEvalSums(int outPsq[2], int outEgDen[2]) const {
+    for (int color = 0; color < 2; color++) {
+        outPsq[color] = outEgDen[color] = 0;
+        for (int rk = 1; rk <= 8; rk++) {
+            int sq = pieceSq[color][rk];
+            if (sq < 0) continue;
+            outPsq[color]   += psqValue[color][rk][sq];
+            outEgDen[color] += egDenValue[color][rk][sq];
+        }
+    }
+}
+
+void Board::refreshAccumulator() {
+    if (nnueActive) nnueRefresh(acc, pieceSq);
+}
+
 // ========================================================================
 //  Capture legality
 // ========================================================================
@@ -345,171 +342,221 @@ bool Board::canCapture(int attackerRank, int defenderRank, int attackerColor,
 }
 
 // ========================================================================
-//  Move generation
+//  Static exchange evaluation
 // ========================================================================
-void Board::addNormalMoves(int sq, int rank, int color, Move* moves, int& count) const {
-    for (int d : DIRS) {
-        if (!canStep(sq, d)) continue;
-        int to = sq + d;
-
-        int ter = terrain[to];
-
-        // Can't enter own den
-        if (color == LIGHT && ter == TERRAIN_DEN_LIGHT) continue;
-        if (color == DARK  && ter == TERRAIN_DEN_DARK)  continue;
-
-        // Only rat can enter water
-        if (ter == TERRAIN_WATER && rank != RAT) continue;
-
-        int target = squares[to];
-        if (target == 0) {
-            // Empty square: always OK
-            moves[count++] = encodeMove(sq, to);
-        } else {
-            // Occupied: check if it's an opponent piece and we can capture
-            int tColor = target > 0 ? LIGHT : DARK;
-            if (tColor == color) continue; // own piece
-            int tRank = abs(target);
-            if (canCapture(rank, tRank, color, sq, to))
-                moves[count++] = encodeMove(sq, to);
+// Least valuable piece of `color` among `occBB` that can capture a `victim`
+// (rank) on `to`: a step from a neighbour under the capture rules (same
+// terrain, rat vs elephant, our traps weaken the victim), or a lion/tiger
+// jump over water with no rat of `occBB` in the way. -1 if there is none.
+int Board::leastAttacker(int to, int victim, int color, Bitboard occBB) const {
+    int best = -1, bestVal = 1 << 30;
+    Bitboard bb = stepBB[to] & occ[color] & occBB;
+    while (bb) {
+        int sq = popLSB(bb);
+        int rk = abs(squares[sq]);
+        if (MATERIAL_VAL[rk] < bestVal && canCapture(rk, victim, color, sq, to)) {
+            best = sq;
+            bestVal = MATERIAL_VAL[rk];
         }
     }
-}
-
-void Board::addJumpMoves(int sq, int rank, int color, Move* moves, int& count) const {
-    const SqJumps& sj = sqJumpLookup[sq];
+    // Jumps are symmetric: the jumpers' squares are the jump targets of `to`
+    const SqJumps& sj = sqJumpLookup[to];
     for (int i = 0; i < sj.count; i++) {
-        int to = sj.dest[i];
-
-        // Can't enter own den (unlikely from a jump but check anyway)
-        if (color == LIGHT && terrain[to] == TERRAIN_DEN_LIGHT) continue;
-        if (color == DARK  && terrain[to] == TERRAIN_DEN_DARK)  continue;
-
-        // Check that no rat blocks the path
-        bool blocked = false;
-        int bStart = sj.blockStart[i];
-        for (int j = 0; j < sj.blockCount[i]; j++) {
-            if (squares[sj.blockingSqs[bStart + j]] != 0) {
-                blocked = true;
-                break;
-            }
-        }
-        if (blocked) continue;
-
-        int target = squares[to];
-        if (target == 0) {
-            moves[count++] = encodeMove(sq, to);
-        } else {
-            int tColor = target > 0 ? LIGHT : DARK;
-            if (tColor == color) continue;
-            int tRank = abs(target);
-            // Jump lands on land, from land: normal capture rules apply
-            if (canCapture(rank, tRank, color, sq, to))
-                moves[count++] = encodeMove(sq, to);
+        int sq = sj.dest[i];
+        if (!(occBB & sqBB(sq)) || (occBB & sj.blockMask[i])) continue;
+        int pc = squares[sq];
+        int rk = abs(pc);
+        if ((pc > 0 ? LIGHT : DARK) != color || (rk != LION && rk != TIGER)) continue;
+        if (MATERIAL_VAL[rk] < bestVal && canCapture(rk, victim, color, sq, to)) {
+            best = sq;
+            bestVal = MATERIAL_VAL[rk];
         }
     }
+    return best;
 }
 
-void Board::generateMoves(Move* moves, int& count) const {
+// Material balance of the exchange a capture starts on its target square,
+// both sides recapturing with their least valuable piece and free to stop.
+// A rat leaving the water can open a river jump behind it.
+int Board::see(Move m) const {
+    int from = moveFrom(m), to = moveTo(m);
+    int gain[2 * NUM_PIECE_TYPES];
+    int d = 0;
+    gain[0] = MATERIAL_VAL[abs(squares[to])];
+
+    Bitboard occBB = (occ[LIGHT] | occ[DARK]) ^ sqBB(from);
+    int onSq  = abs(squares[from]);     // rank of the piece now on `to`
+    int color = sideToMove ^ 1;
+    int sq;
+    while ((sq = leastAttacker(to, onSq, color, occBB)) >= 0) {
+        d++;
+        gain[d] = MATERIAL_VAL[onSq] - gain[d - 1];
+        occBB ^= sqBB(sq);
+        onSq  = abs(squares[sq]);
+        color ^= 1;
+    }
+    // Each side takes the better of stopping and recapturing
+    for (; d > 0; d--)
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    return gain[0];
+}
+
+// ========================================================================
+//  Move generation (bitboards)
+// ========================================================================
+// Targets are built per piece from precomputed step/jump masks. Captures
+// use a mask of the enemy pieces that rank may take on land: every enemy
+// piece of equal or lower rank, plus anything standing on our traps, with
+// the rat/elephant exceptions. Water captures are rat-on-rat only.
+// GEN_COUNT builds the same targets as GEN_ALL but only popcounts them.
+template <Board::GenType Type, int Color>
+void Board::generate(Move* moves, int& count) const {
     count = 0;
-    int color = sideToMove;
+    constexpr int color = Color;
+    constexpr int opp = 1 - Color;
+    Bitboard empty  = ~(occ[LIGHT] | occ[DARK]) & ALL_SQ_BB;
+    Bitboard onTrap = occ[opp] & trapBB[color];
+
+    // weaker[rk] = enemy pieces of rank <= rk
+    Bitboard weaker[NUM_PIECE_TYPES];
+    weaker[0] = 0;
+    for (int rk = 1; rk <= 8; rk++) {
+        int sq = pieceSq[opp][rk];
+        weaker[rk] = weaker[rk - 1] | (sq >= 0 ? sqBB(sq) : 0);
+    }
+    Bitboard oppRat = weaker[RAT];
+    Bitboard oppEle = weaker[ELEPHANT] & ~weaker[LION];
+
     for (int rk = 1; rk <= 8; rk++) {
         int sq = pieceSq[color][rk];
         if (sq < 0) continue; // captured
 
-        // Normal 1-step moves
-        addNormalMoves(sq, rk, color, moves, count);
+        Bitboard landCaps = (weaker[rk] | onTrap) & ~waterBB;
+        if (rk == RAT)      landCaps |= oppEle & ~waterBB;
+        if (rk == ELEPHANT) landCaps &= ~(oppRat & ~trapBB[color]);
 
-        // Jump moves for lion and tiger
+        // Normal 1-step moves (own den is never a target)
+        Bitboard steps = stepBB[sq] & ~denBB[color];
+        if (rk != RAT) steps &= ~waterBB;
+        Bitboard caps = steps & (isWater[sq] ? (oppRat & waterBB) : landCaps);
+        Bitboard targets = 0;
+        if (Type != GEN_QUIETS)   targets |= caps;
+        if (Type != GEN_CAPTURES) targets |= steps & empty;
+
+        // Jump moves for lion and tiger: blocked by any piece in the water
         if (rk == LION || rk == TIGER) {
-            addJumpMoves(sq, rk, color, moves, count);
+            Bitboard occAll = occ[LIGHT] | occ[DARK];
+            const SqJumps& sj = sqJumpLookup[sq];
+            for (int i = 0; i < sj.count; i++) {
+                if (sj.blockMask[i] & occAll) continue;
+                Bitboard to = sqBB(sj.dest[i]) & ~denBB[color];
+                if (Type != GEN_QUIETS)   targets |= to & landCaps;
+                if (Type != GEN_CAPTURES) targets |= to & empty;
+            }
+        }
+
+        if (Type == GEN_COUNT) {
+            count += popcount(targets);
+            continue;
+        }
+        while (targets) {
+            int to = popLSB(targets);
+            assert(squares[to] == 0 ||
+                   canCapture(rk, abs(squares[to]), color, sq, to));
+            moves[count++] = encodeMove(sq, to);
         }
     }
 }
 
+void Board::generateMoves(Move* moves, int& count) const {
+    generate<GEN_ALL>(moves, count);
+}
+
+int Board::countMoves() const {
+    int count = 0;
+    generate<GEN_COUNT>(nullptr, count);
+    return count;
+}
+
 void Board::generateCaptures(Move* moves, int& count) const {
-    count = 0;
-    int color = sideToMove;
-    for (int rk = 1; rk <= 8; rk++) {
-        int sq = pieceSq[color][rk];
-        if (sq < 0) continue;
-
-        // Normal captures
-        for (int d : DIRS) {
-            if (!canStep(sq, d)) continue;
-            int to = sq + d;
-            int ter = terrain[to];
-            if (color == LIGHT && ter == TERRAIN_DEN_LIGHT) continue;
-            if (color == DARK  && ter == TERRAIN_DEN_DARK)  continue;
-            if (ter == TERRAIN_WATER && rk != RAT) continue;
-
-            int target = squares[to];
-            if (target == 0) continue;
-            int tColor = target > 0 ? LIGHT : DARK;
-            if (tColor == color) continue;
-            int tRank = abs(target);
-            if (canCapture(rk, tRank, color, sq, to))
-                moves[count++] = encodeMove(sq, to);
-        }
+    generate<GEN_CAPTURES>(moves, count);
+}
 
-        // Jump captures for lion/tiger
-        if (rk == LION || rk == TIGER) {
-            const SqJumps& sj = sqJumpLookup[sq];
-            for (int i = 0; i < sj.count; i++) {
-                int to = sj.dest[i];
-                if (color == LIGHT && terrain[to] == TERRAIN_DEN_LIGHT) continue;
-                if (color == DARK  && terrain[to] == TERRAIN_DEN_DARK)  continue;
-
-                int target = squares[to];
-                if (target == 0) continue;
-                int tColor = target > 0 ? LIGHT : DARK;
-                if (tColor == color) continue;
-
-                bool blocked = false;
-                int bStart = sj.blockStart[i];
-                for (int j = 0; j < sj.blockCount[i]; j++) {
-                    if (squares[sj.blockingSqs[bStart + j]] != 0) {
-                        blocked = true; break;
-                    }
-                }
-                if (blocked) continue;
+void Board::generateQuiets(Move* moves, int& count) const {
+    generate<GEN_QUIETS>(moves, count);
+}
 
-                int tRank = abs(target);
-                if (canCapture(rk, tRank, color, sq, to))
-                    moves[count++] = encodeMove(sq, to);
-            }
-        }
-    }
+// Full legality check for a move from another position (TT, killers).
+// Jungle has no checks, so every generated move is legal.
+bool Board::isLegal(Move m) const {
+    if (m == MOVE_NONE) return false;
+    int from = moveFrom(m), to = moveTo(m);
+    if (from >= NUM_SQ || to >= NUM_SQ) return false;
+
+    int piece = squares[from];
+    if (piece == 0) return false;
+    int color = piece > 0 ? LIGHT : DARK;
+    int rk    = abs(piece);
+    if (color != sideToMove || (denBB[color] & sqBB(to))) return false;
+
+    if (stepBB[from] & sqBB(to)) {
+        if (isWater[to] && rk != RAT) return false;
+    } else {
+        if (rk != LION && rk != TIGER) return false;
+        const SqJumps& sj = sqJumpLookup[from];
+        bool ok = false;
+        for (int i = 0; i < sj.count; i++)
+            if (sj.dest[i] == to && !(sj.blockMask[i] & (occ[LIGHT] | occ[DARK]))) ok = true;
+        if (!ok) return false;
+    }
+
+    int target = squares[to];
+    if (target == 0) return true;
+    if ((target > 0 ? LIGHT : DARK) == color) return false;
+    return canCapture(rk, abs(target), color, from, to);
 }
 
 // ========================================================================
 //  Make / unmake
 // ========================================================================
-void Board::makeMove(Move m) {
+template <bool CopyMake>
+void Board::doMove(Move m) {
     int from = moveFrom(m);
     int to   = moveTo(m);
     int piece = squares[from];
     int rk    = abs(piece);
     int color = piece > 0 ? LIGHT : DARK;
+    int captured = squares[to];
 
-    // Save undo info
+    // Save undo info (copy-make keeps the whole state elsewhere; the move
+    // is still recorded for the counter-move lookups)
     UndoInfo& u = undoStack[ply];
-    u.captured = squares[to];
-    u.hash     = hash;
-    u.halfmove = halfmove;
-    u.move     = m;
+    u.move = m;
+    if (!CopyMake) {
+        u.captured = (int8_t)captured;
+        u.hash     = hash;
+        u.halfmove = halfmove;
+        u.pliesFromNull = pliesFromNull;
+        u.psq[0]   = psq[0];   u.psq[1]   = psq[1];
+        u.egDen[0] = egDen[0]; u.egDen[1] = egDen[1];
+    }
 
     // Handle capture
-    if (u.captured != 0) {
-        int cRk   = abs(u.captured);
-        int cCol  = u.captured > 0 ? LIGHT : DARK;
+    if (captured != 0) {
+        int cRk   = abs(captured);
+        int cCol  = captured > 0 ? LIGHT : DARK;
         pieceSq[cCol][cRk] = -1;
         pieceCount[cCol]--;
+        occ[cCol] ^= sqBB(to);
         hash ^= zobristPiece[to][cRk][cCol];
+        if (nnueActive) nnueRemovePiece(acc, cCol, cRk, to);
+        psq[cCol]   -= psqValue[cCol][cRk][to];
+        egDen[cCol] -= egDenValue[cCol][cRk][to];
         halfmove = 0;
     } else {
         halfmove++;
     }
+    pliesFromNull++;
 
     // Move piece
     hash ^= zobristPiece[from][rk][color];
@@ -517,6 +564,10 @@ void Board::makeMove(Move m) {
     squares[to]   = piece;
     squares[from] = 0;
     pieceSq[color][rk] = (int8_t)to;
+    occ[color] ^= sqBB(from) | sqBB(to);
+    if (nnueActive) nnueMovePiece(acc, color, rk, from, to);
+    psq[color]   += psqValue[color][rk][to]   - psqValue[color][rk][from];
+    egDen[color] += egDenValue[color][rk][to] - egDenValue[color][rk][from];
 
     // Flip side
     sideToMove = 1 - sideToMove;
@@ -526,6 +577,28 @@ void Board::makeMove(Move m) {
     posHistory[histLen++] = hash;
 }
 
+void Board::makeMove(Move m) {
+    doMove<false>(m);
+}
+
+void Board::makeMove(Move m, BoardState& saved) {
+    saved = *this;
+    doMove<true>(m);
+}
+
+void Board::unmakeMove(const BoardState& saved) {
+    ply--;
+    histLen--;
+    if (nnueActive) {
+        Move m = undoStack[ply].move;
+        int from = moveFrom(m), to = moveTo(m);
+        int piece = saved.squares[from], captured = saved.squares[to];
+        nnueMovePiece(acc, piece > 0 ? LIGHT : DARK, abs(piece), to, from);
+        if (captured != 0) nnueAddPiece(acc, captured > 0 ? LIGHT : DARK, abs(captured), to);
+    }
+    static_cast<BoardState&>(*this) = saved;
+}
+
 void Board::unmakeMove() {
     ply--;
     histLen--;
@@ -537,6 +610,9 @@ void Board::unmakeMove() {
     sideToMove = 1 - sideToMove;
     hash = u.hash;
     halfmove = u.halfmove;
+    pliesFromNull = u.pliesFromNull;
+    psq[0]   = u.psq[0];   psq[1]   = u.psq[1];
+    egDen[0] = u.egDen[0]; egDen[1] = u.egDen[1];
 
     int piece = squares[to];
     int rk    = abs(piece);
@@ -546,6 +622,8 @@ void Board::unmakeMove() {
     squares[from] = piece;
     squares[to]   = u.captured;
     pieceSq[color][rk] = (int8_t)from;
+    occ[color] ^= sqBB(from) | sqBB(to);
+    if (nnueActive) nnueMovePiece(acc, color, rk, to, from);
 
     // Restore captured piece
     if (u.captured != 0) {
@@ -553,6 +631,8 @@ void Board::unmakeMove() {
         int cCol = u.captured > 0 ? LIGHT : DARK;
         pieceSq[cCol][cRk] = (int8_t)to;
         pieceCount[cCol]++;
+        occ[cCol] ^= sqBB(to);
+        if (nnueActive) nnueAddPiece(acc, cCol, cRk, to);
     }
 }
 
@@ -561,8 +641,11 @@ void Board::makeNullMove() {
     u.captured = 0;
     u.hash     = hash;
     u.halfmove = halfmove;
+    u.pliesFromNull = pliesFromNull;
     u.move     = MOVE_NONE;
 
+    // Not a move: the clock stands, and the repetition scans stop here
+    pliesFromNull = 0;
     sideToMove = 1 - sideToMove;
     hash ^= zobristSide;
     ply++;
@@ -576,15 +659,19 @@ void Board::unmakeNullMove() {
     sideToMove = 1 - sideToMove;
     hash = u.hash;
     halfmove = u.halfmove;
+    pliesFromNull = u.pliesFromNull;
 }
 
 // ========================================================================
 //  Repetition detection
 // ========================================================================
+// Only positions since the last capture can repeat: the scan stops
+// `halfmove` plies back instead of at the start of the game, and never
+// looks across a null move
 bool Board::isRepetition() const {
-    if (histLen < 5) return false;
+    int stop = std::max(0, histLen - 1 - repetitionWindow());
     int count = 0;
-    for (int i = histLen - 3; i >= 0; i -= 2) {
+    for (int i = histLen - 3; i >= stop; i -= 2) {
         if (posHistory[i] == hash) {
             count++;
             if (count >= 2) return true; // 3-fold
@@ -593,6 +680,41 @@ bool Board::isRepetition() const {
     return false;
 }
 
+// Can the side to move repeat a position for the third time with one
+// quiet move? The hash difference to each earlier position with the other
+// side to move is looked up in the cuckoo tables; a hit is a reversible
+// move whose piece is ours and whose path is free.
+bool Board::hasUpcomingRepetition() const {
+    int end = std::min(repetitionWindow(), histLen - 1);
+    if (end < 3) return false;
+    Bitboard occAll = occ[LIGHT] | occ[DARK];
+    for (int i = 3; i <= end; i += 2) {
+        int k = histLen - 1 - i;
+        uint64_t moveKey = hash ^ posHistory[k];
+        int j = cuckooH1(moveKey);
+        if (CUCKOO.key[j] != moveKey) {
+            j = cuckooH2(moveKey);
+            if (CUCKOO.key[j] != moveKey) continue;
+        }
+        int s1 = moveFrom(CUCKOO.move[j]), s2 = moveTo(CUCKOO.move[j]);
+        int from = squares[s1] ? s1 : s2, to = from ^ s1 ^ s2;
+        if (squares[to] != 0 || squares[from] == 0) continue;
+        if ((squares[from] > 0 ? LIGHT : DARK) != sideToMove) continue;
+        if (!(stepBB[from] & sqBB(to))) {
+            const SqJumps& sj = sqJumpLookup[from];
+            bool blocked = true;
+            for (int n = 0; n < sj.count; n++)
+                if (sj.dest[n] == to) blocked = (sj.blockMask[n] & occAll) != 0;
+            if (blocked) continue;
+        }
+        // The move reaches posHistory[k]: a draw if it occurred once before
+        int stop = std::max(0, histLen - 1 - repetitionWindow());
+        for (int t = k - 2; t >= stop; t -= 2)
+            if (posHistory[t] == posHistory[k]) return true;
+    }
+    return false;
+}
+
 // ========================================================================
 //  Game-over detection  (called at the top of search before generating moves)
 // ========================================================================
@@ -621,133 +743,121 @@ int Board::checkGameOver() const {
 //  Static evaluation (from side-to-move's perspective)
 // ========================================================================
 int Board::evaluate() const {
+    if (nnueActive) {
+#ifndef NDEBUG
+        Accumulator full;
+        nnueRefresh(full, pieceSq);
+        assert(memcmp(&full, &acc, sizeof(acc)) == 0);
+#endif
+        return nnueEvaluate(acc, sideToMove);
+    }
+
     int score = 0;
     int stm = sideToMove;
     int opp = 1 - stm;
 
-    // ---- Material + PST ----
-    for (int color = 0; color < 2; color++) {
-        int sign = (color == stm) ? 1 : -1;
-        for (int rk = 1; rk <= 8; rk++) {
-            int sq = pieceSq[color][rk];
-            if (sq < 0) continue;
+    // ---- Material + PST + den proximity (incremental) ----
+#ifndef NDEBUG
+    {
+        int fullPsq[2], fullEg[2];
+        computeEvalSums(fullPsq, fullEg);
+        assert(fullPsq[0] == psq[0] && fullPsq[1] == psq[1]);
+        assert(fullEg[0] == egDen[0] && fullEg[1] == egDen[1]);
+    }
+#endif
+    score += psq[stm] - psq[opp];
 
-            // Material
-            score += sign * MATERIAL_VAL[rk];
+    auto add = [&](int i, int c) { score += c * evalParams[i]; };
+    if (stm == LIGHT) evalTerms<LIGHT>(add);
+    else              evalTerms<DARK>(add);
 
-            // PST (oriented for this color)
-            int pstSq = (color == LIGHT) ? sq : (NUM_SQ - 1 - sq);
-            score += sign * PST[rk][pstSq];
-        }
-    }
+    // ---- Endgame adjustment: emphasise den proximity when few pieces ----
+    int totalPieces = pieceCount[0] + pieceCount[1];
+    if (totalPieces <= 6) score += egDen[stm];
 
-    // ---- Den proximity bonus (extra beyond PST) ----
-    // For our pieces: bonus for being close to opponent den
-    // For opponent pieces: penalty for being close to our den
-    for (int color = 0; color < 2; color++) {
-        int sign = (color == stm) ? 1 : -1;
-        int targetDen = (color == LIGHT) ? 1 : 0; // which den we're attacking
-        for (int rk = 1; rk <= 8; rk++) {
-            int sq = pieceSq[color][rk];
-            if (sq < 0) continue;
+    return score;
+}
 
-            // Pick appropriate distance table
-            int d;
-            if (rk == RAT) d = distSwimmer[targetDen][sq];
-            else if (rk == LION || rk == TIGER) d = distJumper[targetDen][sq];
-            else d = distLand[targetDen][sq];
-
-            // Exponential bonus for proximity
-            if (d <= 1) score += sign * 250;
-            else if (d == 2) score += sign * 120;
-            else if (d == 3) score += sign * 60;
-            else if (d <= 5) score += sign * 20;
-        }
-    }
+// ========================================================================
+//  Eval terms
+// ========================================================================
+// Everything evaluate() adds beyond the incremental sums, reported as
+// add(parameter, coefficient) from the side to move's point of view
+template <int Stm, typename Add>
+void Board::evalTerms(Add&& add) const {
+    constexpr int stm = Stm;
+    constexpr int opp = 1 - Stm;
 
     // ---- Trap control ----
     // Opponent piece on our trap = good (it's weakened)
     // Our piece on opponent's trap = bad (we're weakened)
-    for (int sq = 0; sq < NUM_SQ; sq++) {
-        if (squares[sq] == 0) continue;
-        int pc = squares[sq];
-        int pcColor = pc > 0 ? LIGHT : DARK;
-        int pcRank  = abs(pc);
-
-        if (pcColor == stm) {
-            // Our piece on opponent's trap: penalty
-            if ((stm == LIGHT && terrain[sq] == TERRAIN_TRAP_DARK) ||
-                (stm == DARK  && terrain[sq] == TERRAIN_TRAP_LIGHT)) {
-                score -= MATERIAL_VAL[pcRank] / 3;
-            }
-        } else {
-            // Opponent piece on our trap: bonus
-            if ((opp == LIGHT && terrain[sq] == TERRAIN_TRAP_DARK) ||
-                (opp == DARK  && terrain[sq] == TERRAIN_TRAP_LIGHT)) {
-                score += MATERIAL_VAL[pcRank] / 3;
-            }
-        }
-    }
+    for (Bitboard b = occ[stm] & trapBB[opp]; b; )
+        add(EP_TRAP + abs(squares[popLSB(b)]), -1);
+    for (Bitboard b = occ[opp] & trapBB[stm]; b; )
+        add(EP_TRAP + abs(squares[popLSB(b)]), 1);
 
     // ---- Rat-Elephant dynamics ----
     // If we have a rat and opponent has elephant, that's a threat we possess
     if (pieceSq[stm][RAT] >= 0 && pieceSq[opp][ELEPHANT] >= 0) {
-        int ratSq = pieceSq[stm][RAT];
-        int eleSq = pieceSq[opp][ELEPHANT];
-        int dr = abs(sqRow(ratSq) - sqRow(eleSq));
-        int dc = abs(sqCol(ratSq) - sqCol(eleSq));
-        int dist = dr + dc;
-        score += 40; // having the threat
-        if (dist <= 2) score += 60; // close threat
-        if (dist == 1) score += 80; // adjacent = very dangerous
+        int dist = sqDistance[pieceSq[stm][RAT]][pieceSq[opp][ELEPHANT]];
+        add(EP_RAT_THREAT + 0, 1);                // having the threat
+        if (dist <= 2) add(EP_RAT_THREAT + 1, 1);  // close threat
+        if (dist == 1) add(EP_RAT_THREAT + 2, 1);  // adjacent = very dangerous
     }
     // If opponent has rat and we have elephant, that's a threat against us
     if (pieceSq[opp][RAT] >= 0 && pieceSq[stm][ELEPHANT] >= 0) {
-        int ratSq = pieceSq[opp][RAT];
-        int eleSq = pieceSq[stm][ELEPHANT];
-        int dr = abs(sqRow(ratSq) - sqRow(eleSq));
-        int dc = abs(sqCol(ratSq) - sqCol(eleSq));
-        int dist = dr + dc;
-        score -= 30;
-        if (dist <= 2) score -= 40;
-        if (dist == 1) score -= 60;
+        int dist = sqDistance[pieceSq[opp][RAT]][pieceSq[stm][ELEPHANT]];
+        add(EP_RAT_DANGER + 0, -1);
+        if (dist <= 2) add(EP_RAT_DANGER + 1, -1);
+        if (dist == 1) add(EP_RAT_DANGER + 2, -1);
     }
 
     // ---- Den safety ----
-    // Penalty for opponent pieces near our den
-    int ourDenSq = (stm == LIGHT) ? DEN_LIGHT_SQ : DEN_DARK_SQ;
-    for (int rk = 1; rk <= 8; rk++) {
-        int sq = pieceSq[opp][rk];
-        if (sq < 0) continue;
-        int dr = abs(sqRow(sq) - sqRow(ourDenSq));
-        int dc = abs(sqCol(sq) - sqCol(ourDenSq));
-        int dist = dr + dc;
-        if (dist <= 1) score -= 300;
-        else if (dist == 2) score -= 100;
-        else if (dist == 3) score -= 30;
+    // Penalty for opponent pieces near our den: one popcount per distance
+    // ring instead of a distance per piece
+    int near[3];
+    for (int i = 0; i < 3; i++) near[i] = popcount(occ[opp] & denNearBB[stm][i]);
+#ifndef NDEBUG
+    {
+        // Scalar reference
+        int ref[3] = {};
+        int ourDenSq = (stm == LIGHT) ? DEN_LIGHT_SQ : DEN_DARK_SQ;
+        for (int rk = 1; rk <= 8; rk++) {
+            int sq = pieceSq[opp][rk];
+            if (sq < 0) continue;
+            int dist = abs(sqRow(sq) - sqRow(ourDenSq)) + abs(sqCol(sq) - sqCol(ourDenSq));
+            if (dist <= 3) ref[dist <= 1 ? 0 : dist - 1]++;
+        }
+        assert(ref[0] == near[0] && ref[1] == near[1] && ref[2] == near[2]);
     }
+#endif
+    for (int i = 0; i < 3; i++)
+        if (near[i]) add(EP_DEN_SAFETY + i, -near[i]);
 
     // ---- Piece count advantage bonus ----
     int pieceDiff = pieceCount[stm] - pieceCount[opp];
-    score += pieceDiff * 30;
+    add(EP_PIECE_COUNT, pieceDiff);
+}
 
-    // ---- Endgame adjustment: emphasise den proximity when few pieces ----
+// d evaluate() / d evalParams[i] for the handcrafted eval: evaluate()
+// equals the sum of coef[i] * evalParams[i]
+void Board::evalTrace(int* coef) const {
+    memset(coef, 0, sizeof(int) * NUM_EVAL_PARAMS);
+    int stm = sideToMove;
     int totalPieces = pieceCount[0] + pieceCount[1];
-    if (totalPieces <= 6) {
-        // Recompute den proximity with higher weight
+    for (int color = 0; color < 2; color++) {
+        int sign = (color == stm) ? 1 : -1;
         for (int rk = 1; rk <= 8; rk++) {
-            int sq = pieceSq[stm][rk];
+            int sq = pieceSq[color][rk];
             if (sq < 0) continue;
-            int d;
-            int targetDen = (stm == LIGHT) ? 1 : 0;
-            if (rk == RAT) d = distSwimmer[targetDen][sq];
-            else if (rk == LION || rk == TIGER) d = distJumper[targetDen][sq];
-            else d = distLand[targetDen][sq];
-            if (d <= 3) score += (4 - d) * 80;
+            psqTerms(color, rk, sq, [&](int i, int c) { coef[i] += sign * c; });
+            if (color == stm && totalPieces <= 6)
+                egDenTerms(color, rk, sq, [&](int i, int c) { coef[i] += c; });
         }
     }
-
-    return score;
+    auto add = [&](int i, int c) { coef[i] += c; };
+    if (stm == LIGHT) evalTerms<LIGHT>(add);
+    else              evalTerms<DARK>(add);
 }
 
 // ========================================================================
@@ -1,27 +1,50 @@
 #pragma once
 #include "types.h"
+#include "nnue.h"
+#include "evalparams.h"
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
 struct UndoInfo {
-    int8_t captured;    // signed piece on target before move (0 if empty)
     uint64_t hash;
-    int halfmove;       // half-move clock for repetition / 50-move
-    Move move;
+    int      psq[2];    // incremental eval sums before the move
+    int      egDen[2];
+    Move     move;
+    uint16_t halfmove;  // half-move clock for repetition / 50-move
+    uint16_t pliesFromNull;
+    int8_t   captured;  // signed piece on target before move (0 if empty)
 };
 
-class Board {
-public:
+// ---- Position state ----
+// Everything a move changes, in two cache lines. Board adds the game
+// history on top; a copy-make search keeps one of these per ply.
+struct alignas(64) BoardState {
     // Board state: 0=empty, +1..+8=Light piece, -1..-8=Dark piece
-    int8_t squares[NUM_SQ];
-    int    sideToMove;      // LIGHT or DARK
+    int8_t   squares[NUM_SQ];
+    // Piece tracking: pieceSq[color][rank] = square (-1 if captured)
+    int8_t   pieceSq[2][NUM_PIECE_TYPES];
+    int8_t   pieceCount[2]; // alive piece count per side
+    uint8_t  sideToMove;    // LIGHT or DARK
+    uint16_t halfmove;      // half-moves since last capture
+    uint16_t pliesFromNull; // moves since the last null move (search only)
+    Bitboard occ[2];        // occupancy per colour
     uint64_t hash;
+
+    // Incremental eval terms that depend only on piece placement, per colour:
+    //   psq   = material + PST + den proximity
+    //   egDen = endgame den-race bonus (used when few pieces remain)
+    int      psq[2];
+    int      egDen[2];
+};
+static_assert(sizeof(BoardState) == 128, "BoardState should fill two cache lines");
+
+class Board : public BoardState {
+public:
     int    ply;             // game ply (0 = start)
-    int    halfmove;        // half-moves since last capture
 
-    // Piece tracking: pieceSq[color][rank] = square (-1 if captured)
-    int8_t pieceSq[2][NUM_PIECE_TYPES];
-    int    pieceCount[2];   // alive piece count per side
+    // Neural eval accumulator (maintained only while a network is loaded)
+    Accumulator acc;
 
     // Undo stack
     UndoInfo undoStack[MAX_GAME_LEN];
@@ -30,6 +53,11 @@ public:
     uint64_t posHistory[MAX_GAME_LEN];
     int histLen;
 
+    Board() = default;
+    // Copies only the used part of the history (a full Board is ~64 KB)
+    Board(const Board& o) { *this = o; }
+    Board& operator=(const Board& o);
+
     // ---- Methods ----
     void init();                                // starting position
     bool setFEN(const std::string& fen);
@@ -37,26 +65,52 @@ public:
 
     void generateMoves(Move* moves, int& count) const;
     void generateCaptures(Move* moves, int& count) const;
+    void generateQuiets(Move* moves, int& count) const;
+    int  countMoves() const;        // number of legal moves, nothing generated
+    bool isLegal(Move m) const;     // validates TT/killer moves
+    int  see(Move m) const;         // static exchange value of a capture
 
     void makeMove(Move m);
     void unmakeMove();
+    // Copy-make: `saved` receives the state before the move and is copied
+    // back on unmake instead of reversing the move. Pairs only with itself.
+    void makeMove(Move m, BoardState& saved);
+    void unmakeMove(const BoardState& saved);
     void makeNullMove();
     void unmakeNullMove();
 
+    // Plies back a repetition can reach: since the last capture or null move
+    int  repetitionWindow() const { return std::min(halfmove, pliesFromNull); }
     bool isRepetition() const;
+    bool hasUpcomingRepetition() const; // one of our quiet moves makes a 3-fold
     // Returns 0 = game not over, +1 = side-to-move just won (should not happen mid-search),
     //         -1 = side-to-move just lost (opponent reached den or we have no pieces)
     int  checkGameOver() const;
 
     int evaluate() const;
+    void evalTrace(int* coef) const;    // NUM_EVAL_PARAMS coefficients, see evalparams.h
+    void refreshAccumulator();      // after loading a network mid-game
 
     uint64_t perft(int depth);
     void display() const;
 
 private:
-    void addNormalMoves(int sq, int rank, int color, Move* moves, int& count) const;
-    void addJumpMoves(int sq, int rank, int color, Move* moves, int& count) const;
+    template <bool CopyMake>
+    void doMove(Move m);
+    enum GenType { GEN_ALL, GEN_CAPTURES, GEN_QUIETS, GEN_COUNT };
+    // Specialised by colour: masks and directions fold to constants
+    template <GenType Type, int Color>
+    void generate(Move* moves, int& count) const;
+    template <GenType Type>
+    void generate(Move* moves, int& count) const {
+        if (sideToMove == LIGHT) generate<Type, LIGHT>(moves, count);
+        else                     generate<Type, DARK>(moves, count);
+    }
     bool canCapture(int attackerRank, int defenderRank, int attackerColor,
                     int fromSq, int toSq) const;
+    int  leastAttacker(int to, int victim, int color, Bitboard occBB) const;
     void computeHash();
+    void computeEvalSums(int outPsq[2], int outEgDen[2]) const;
+    template <int Stm, typename Add>
+    void evalTerms(Add&& add) const;
 };
@@ -0,0 +1,136 @@
+#include "book.h"
+#include "mapfile.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+static MappedFile bookFile;
+
+// ========================================================================
+//  Loading and probing
+// ========================================================================
+bool bookLoad(const std::string& path) {
+    bookFree();
+    if (!bookFile.open(path)) return false;
+    if (bookFile.size % sizeof(BookEntry) != 0) {
+        bookFree();
+        return false;
+    }
+    return true;
+}
+
+void bookFree() {
+    bookFile.close();
+}
+
+bool bookLoaded() {
+    return bookFile.data != nullptr;
+}
+
+Move bookProbe(const Board& b) {
+    if (!bookLoaded()) return MOVE_NONE;
+    const BookEntry* begin = (const BookEntry*)bookFile.data;
+    const BookEntry* end   = begin + bookFile.size / sizeof(BookEntry);
+    const BookEntry* it = std::lower_bound(begin, end, b.hash,
+        [](const BookEntry& e, uint64_t key) { return e.key < key; });
+
+    // Weighted pick among the legal candidates
+    Move cand[MAX_MOVES];
+    uint32_t weight[MAX_MOVES];
+    int n = 0;
+    uint32_t total = 0;
+    for (; it != end && it->key == b.hash && n < MAX_MOVES; ++it) {
+        if (it->weight == 0 || !b.isLegal(it->move)) continue;
+        cand[n] = it->move;
+        weight[n] = it->weight;
+        total += it->weight;
+        n++;
+    }
+    if (n == 0) return MOVE_NONE;
+
+    static std::mt19937 rng(std::random_device{}());
+    uint32_t r = std::uniform_int_distribution<uint32_t>(0, total - 1)(rng);
+    for (int i = 0; i < n; i++) {
+        if (r < weight[i]) return cand[i];
+        r -= weight[i];
+    }
+    return cand[n - 1];
+}
+
+// ========================================================================
+//  Building
+// ========================================================================
+bool bookBuild(const std::string& input, const std::string& output, int maxPly) {
+    std::ifstream in(input);
+    if (!in) {
+        std::printf("info string book: cannot read %s\n", input.c_str());
+        return false;
+    }
+
+    struct Played { uint64_t key; Move move; int side; };
+    std::vector<BookEntry> entries;
+    Board b;
+    std::string line;
+    int games = 0;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string tok;
+        b.init();
+        std::vector<Played> played;
+        int result = -1;            // winning colour, 2 = draw, -1 = unknown
+        bool bad = false;
+        while (iss >> tok) {
+            if (tok == "position" || tok == "startpos" || tok == "moves") continue;
+            if (tok == "fen") {
+                std::string fen, t;
+                while (iss >> t && t != "moves") fen += (fen.empty() ? "" : " ") + t;
+                if (!b.setFEN(fen)) { bad = true; break; }
+                continue;
+            }
+            if (tok == "1-0") { result = LIGHT; break; }
+            if (tok == "0-1") { result = DARK; break; }
+            if (tok == "1/2-1/2") { result = 2; break; }
+            if (tok.back() == '.') continue;
+
+            Move m = strToMove(tok);
+            if (m == MOVE_NONE || !b.isLegal(m)) { bad = true; break; }
+            if ((int)played.size() < maxPly) played.push_back({b.hash, m, b.sideToMove});
+            b.makeMove(m);
+            if (b.checkGameOver() != 0) break;
+        }
+        if (bad || played.empty()) continue;
+        games++;
+        for (const Played& p : played) {
+            uint16_t w = result < 0 ? 1 : result == 2 ? 1 : result == p.side ? 2 : 0;
+            entries.push_back({p.key, p.move, w, 0});
+        }
+    }
+
+    // Merge duplicates, then order candidates by weight within a key
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& c) {
+        return a.key != c.key ? a.key < c.key : a.move < c.move;
+    });
+    std::vector<BookEntry> merged;
+    for (const BookEntry& e : entries) {
+        if (!merged.empty() && merged.back().key == e.key && merged.back().move == e.move)
+            merged.back().weight = (uint16_t)std::min(65535, merged.back().weight + e.weight);
+        else
+            merged.push_back(e);
+    }
+    merged.erase(std::remove_if(merged.begin(), merged.end(),
+                 [](const BookEntry& e) { return e.weight == 0; }), merged.end());
+    std::stable_sort(merged.begin(), merged.end(), [](const BookEntry& a, const BookEntry& c) {
+        return a.key != c.key ? a.key < c.key : a.weight > c.weight;
+    });
+
+    FILE* f = std::fopen(output.c_str(), "wb");
+    bool ok = f && std::fwrite(merged.data(), sizeof(BookEntry), merged.size(), f) == merged.size();
+    if (f) ok = (std::fclose(f) == 0) && ok;
+    std::printf("info string book: %d games, %zu entries %s %s\n", games, merged.size(),
+                ok ? "written to" : "could not be written to", output.c_str());
+    fflush(stdout);
+    return ok;
+}
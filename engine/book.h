@@ -0,0 +1,30 @@
+#pragma once
+#include "board.h"
+
+// ---- Opening book ----
+// A file of 16-byte records sorted by key, found by binary search on the
+// memory-mapped file:
+//   uint64 key (Board::hash), uint16 move, uint16 weight, uint32 reserved
+// Several records with the same key are the candidate moves; one is
+// picked at random in proportion to its weight.
+struct BookEntry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;
+    uint32_t reserved;
+};
+static_assert(sizeof(BookEntry) == 16, "book records are 16 bytes");
+
+bool bookLoad(const std::string& path);     // false = no book loaded
+void bookFree();
+bool bookLoaded();
+
+// A legal book move for the position, MOVE_NONE if out of book
+Move bookProbe(const Board& b);
+
+// Builds a book from a text file with one game per line:
+//   [position startpos|fen <fen>] [moves] <move> <move> ... [result]
+// Move numbers ("1.") are skipped; a result (1-0, 0-1, 1/2-1/2) weights
+// the winner's moves 2, drawn games 1 and the loser's 0 (no result: 1).
+// Only the first `maxPly` plies of each game are used.
+bool bookBuild(const std::string& input, const std::string& output, int maxPly);
@@ -0,0 +1,275 @@
+#include "capi.h"
+#include "search.h"
+#include "tablebase.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+static_assert(JUNGLE_MOVE_NONE == MOVE_NONE && JUNGLE_MAX_MOVES == MAX_MOVES &&
+              JUNGLE_SCORE_MATE == SCORE_MATE, "capi.h constants out of date");
+
+// A board keeps its NNUE accumulator up to date only while a network is
+// loaded: one made before jungle_load_eval_file refreshes on its next eval
+static std::atomic<int> evalGeneration(0);
+
+// Searches of all handles that are probing tables / evaluating: eval file
+// and tablebases are only swapped while there are none
+static std::mutex globalMutex;
+static int        runningSearches = 0;
+
+struct jungle_board {
+    Board b;
+    int   evalGen = -1;
+};
+
+struct jungle_search {
+    Search            s;
+    std::thread       th;
+    std::atomic<bool> running{false};
+    Move              best = MOVE_NONE;
+    int               evalGen = 0;    // evaluator its caches and TT were filled with
+
+    void idle() { if (th.joinable()) th.join(); }
+};
+
+// The game history must leave room for a full-depth search on top
+static constexpr int MAX_API_PLY = MAX_GAME_LEN - MAX_PLY - 1;
+
+extern "C" {
+
+int jungle_api_version(void) { return JUNGLE_API_VERSION; }
+
+int jungle_load_eval_file(const char* path) {
+    std::lock_guard<std::mutex> lock(globalMutex);
+    if (runningSearches) return -1;
+    if (!path || !*path) nnueUnload();
+    else if (!nnueLoad(path)) return 0;
+    evalGeneration++;
+    return 1;
+}
+
+int jungle_load_tablebases(const char* dir) {
+    std::lock_guard<std::mutex> lock(globalMutex);
+    if (runningSearches) return -1;
+    if (!dir || !*dir) {
+        tbFree();
+        return 0;
+    }
+    return tbInit(dir);
+}
+
+// ========================================================================
+//  Board
+// ========================================================================
+jungle_board* jungle_board_new(void) {
+    jungle_board* b = new jungle_board;
+    b->b.init();
+    return b;
+}
+
+jungle_board* jungle_board_clone(const jungle_board* b) { return new jungle_board(*b); }
+
+void jungle_board_free(jungle_board* b) { delete b; }
+
+void jungle_board_startpos(jungle_board* b) {
+    b->b.init();
+    b->evalGen = -1;
+}
+
+int jungle_board_set_fen(jungle_board* b, const char* fen) {
+    Board t;
+    if (!fen || !t.setFEN(fen)) return 0;
+    b->b = t;
+    b->evalGen = -1;
+    return 1;
+}
+
+int jungle_board_fen(const jungle_board* b, char* buf, int size) {
+    std::string fen = b->b.toFEN();
+    if (buf && size > 0) {
+        size_t n = std::min(fen.size(), (size_t)size - 1);
+        std::memcpy(buf, fen.data(), n);
+        buf[n] = '\0';
+    }
+    return (int)fen.size();
+}
+
+int jungle_board_side_to_move(const jungle_board* b) { return b->b.sideToMove; }
+
+int jungle_board_piece(const jungle_board* b, int sq) {
+    return (sq >= 0 && sq < NUM_SQ) ? b->b.squares[sq] : 0;
+}
+
+int jungle_board_ply(const jungle_board* b) { return b->b.ply; }
+
+uint64_t jungle_board_hash(const jungle_board* b) { return b->b.hash; }
+
+int jungle_board_moves(const jungle_board* b, uint16_t* out, int max) {
+    Move moves[MAX_MOVES];
+    int count = 0;
+    b->b.generateMoves(moves, count);
+    std::copy(moves, moves + std::min(count, std::max(max, 0)), out);
+    return count;
+}
+
+int jungle_board_make_move(jungle_board* b, uint16_t move) {
+    if (b->b.ply >= MAX_API_PLY || !b->b.isLegal(move)) return 0;
+    b->b.makeMove(move);
+    return 1;
+}
+
+int jungle_board_unmake_move(jungle_board* b) {
+    if (b->b.ply == 0) return 0;
+    b->b.unmakeMove();
+    return 1;
+}
+
+int jungle_board_evaluate(jungle_board* b) {
+    int gen = evalGeneration;
+    if (b->evalGen != gen) {
+        b->b.refreshAccumulator();
+        b->evalGen = gen;
+    }
+    return b->b.evaluate();
+}
+
+int jungle_board_game_over(const jungle_board* b) { return b->b.checkGameOver(); }
+
+int jungle_board_is_repetition(const jungle_board* b) { return b->b.isRepetition(); }
+
+int jungle_move_str(uint16_t move, char buf[5]) {
+    std::string s = moveToStr(move);
+    std::memcpy(buf, s.c_str(), 5);
+    return 4;
+}
+
+uint16_t jungle_move_parse(const char* s) { return s ? strToMove(s) : MOVE_NONE; }
+
+// ========================================================================
+//  Search
+// ========================================================================
+jungle_search* jungle_search_new(int hash_mb, int threads) {
+    jungle_search* s = new jungle_search;
+    s->s.init(std::max(1, hash_mb));
+    s->s.setThreads(std::max(1, threads));
+    s->s.board.init();
+    s->s.silent = true;
+    s->evalGen = evalGeneration;
+    return s;
+}
+
+void jungle_search_free(jungle_search* s) {
+    s->s.stop();
+    s->idle();
+    s->s.setThreads(1);
+    s->s.destroy();
+    delete s;
+}
+
+void jungle_search_set_position(jungle_search* s, const jungle_board* b) {
+    s->idle();
+    s->s.board = b->b;
+    s->s.board.refreshAccumulator();
+}
+
+void jungle_search_new_game(jungle_search* s) {
+    s->idle();
+    s->s.newGame();
+}
+
+void jungle_search_set_hash(jungle_search* s, int mb) {
+    s->idle();
+    s->s.resizeTT(std::max(1, mb));
+}
+
+void jungle_search_set_threads(jungle_search* s, int threads) {
+    s->idle();
+    s->s.setThreads(std::max(1, threads));
+}
+
+void jungle_search_set_multipv(jungle_search* s, int lines) {
+    s->idle();
+    s->s.multiPV = std::max(1, std::min(64, lines));
+}
+
+int jungle_search_start(jungle_search* s, const jungle_limits* limits,
+                        jungle_info_fn on_info, jungle_done_fn on_done, void* user) {
+    if (s->running) return 0;
+    s->idle();
+    int gen = evalGeneration;
+    if (s->evalGen != gen) {
+        s->s.board.refreshAccumulator();
+        s->s.clearEvals();
+        s->evalGen = gen;
+    }
+
+    SearchLimits l;
+    if (limits) {
+        l.depth     = limits->depth;
+        l.movetime  = limits->movetime;
+        l.nodes     = limits->nodes;
+        l.time[LIGHT] = limits->time[0];  l.time[DARK] = limits->time[1];
+        l.inc[LIGHT]  = limits->inc[0];   l.inc[DARK]  = limits->inc[1];
+        l.movestogo = limits->movestogo;
+        l.infinite  = limits->infinite != 0;
+        if (limits->searchmoves)
+            l.searchMoves.assign(limits->searchmoves, limits->searchmoves + limits->num_searchmoves);
+    }
+
+    Search& search = s->s;
+    search.onInfo = nullptr;
+    if (on_info)
+        search.onInfo = [&search, on_info, user](int depth, int multipv, const RootLine& line, int64_t ms) {
+            jungle_info info;
+            info.depth    = depth;
+            info.seldepth = line.selDepth;
+            info.multipv  = multipv;
+            info.score    = line.score;
+            info.nodes    = search.totalNodes();
+            info.time_ms  = ms;
+            info.hashfull = search.hashTable().hashfull();
+            info.pv_len   = line.len;
+            info.pv       = line.pv;
+            on_info(user, &info);
+        };
+
+    // As for "go": return once think() has reset its flags, so that a stop
+    // right after the start is not lost
+    s->running = true;
+    {
+        std::lock_guard<std::mutex> lock(globalMutex);
+        runningSearches++;
+    }
+    int64_t started = search.searchCount();
+    s->th = std::thread([s, l, on_done, user] {
+        Move best = s->s.think(l);
+        {
+            std::lock_guard<std::mutex> lock(globalMutex);
+            runningSearches--;
+        }
+        s->best = best;
+        if (on_done) on_done(user, best, s->s.ponderMove(), s->s.bestLine().score);
+        s->running = false;
+    });
+    while (search.searchCount() == started) std::this_thread::yield();
+    return 1;
+}
+
+void jungle_search_stop(jungle_search* s) { s->s.stop(); }
+
+int jungle_search_running(const jungle_search* s) { return s->running; }
+
+uint16_t jungle_search_wait(jungle_search* s) {
+    s->idle();
+    return s->best;
+}
+
+uint16_t jungle_search_ponder_move(const jungle_search* s) { return s->s.ponderMove(); }
+
+int jungle_search_score(const jungle_search* s) { return s->s.bestLine().score; }
+
+int64_t jungle_search_nodes(const jungle_search* s) { return s->s.totalNodes(); }
+
+}   // extern "C"
@@ -0,0 +1,125 @@
+#pragma once
+#include <stdint.h>
+
+// ---- C API (libjungle) ----
+// Boards and searchers for in-process use from other languages: `make lib`
+// builds libjungle.so, python/jungle.py wraps it with ctypes. Handles are
+// opaque; moves are the engine's 16-bit encoding (from | to << 6, 0xFFFF =
+// none), squares 0..62 = a1, b1, ... g9. Functions on different handles
+// may run on different threads at the same time; one handle is not
+// thread-safe.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define JUNGLE_API __declspec(dllexport)
+#else
+#define JUNGLE_API __attribute__((visibility("default")))
+#endif
+
+#define JUNGLE_API_VERSION 1
+#define JUNGLE_MOVE_NONE   0xFFFF
+#define JUNGLE_MAX_MOVES   80
+
+typedef struct jungle_board  jungle_board;
+typedef struct jungle_search jungle_search;
+
+JUNGLE_API int jungle_api_version(void);
+
+// Global engine state, shared by all handles: EvalFile ("" = handcrafted)
+// and TablebasePath (returns the number of files, "" = unload). Both return
+// -1 and change nothing while a search of any handle is running, and must
+// not overlap jungle_board_evaluate on another thread.
+JUNGLE_API int jungle_load_eval_file(const char* path);    // 0 = kept the previous eval
+JUNGLE_API int jungle_load_tablebases(const char* dir);
+
+// ========================================================================
+//  Board
+// ========================================================================
+JUNGLE_API jungle_board* jungle_board_new(void);           // starting position
+JUNGLE_API jungle_board* jungle_board_clone(const jungle_board* b);
+JUNGLE_API void jungle_board_free(jungle_board* b);
+
+JUNGLE_API void jungle_board_startpos(jungle_board* b);
+JUNGLE_API int  jungle_board_set_fen(jungle_board* b, const char* fen);   // 0 = bad FEN, board unchanged
+// Writes the FEN NUL-terminated, truncated to size; returns its length
+JUNGLE_API int  jungle_board_fen(const jungle_board* b, char* buf, int size);
+
+JUNGLE_API int      jungle_board_side_to_move(const jungle_board* b);     // 0 = Light, 1 = Dark
+JUNGLE_API int      jungle_board_piece(const jungle_board* b, int sq);    // +rank Light, -rank Dark, 0
+JUNGLE_API int      jungle_board_ply(const jungle_board* b);              // moves that can be unmade
+JUNGLE_API uint64_t jungle_board_hash(const jungle_board* b);
+
+// Legal moves into out[max] (JUNGLE_MAX_MOVES is always enough); returns the count
+JUNGLE_API int  jungle_board_moves(const jungle_board* b, uint16_t* out, int max);
+JUNGLE_API int  jungle_board_make_move(jungle_board* b, uint16_t move);   // 0 = illegal, not made
+JUNGLE_API int  jungle_board_unmake_move(jungle_board* b);                // 0 = nothing to unmake
+// Static eval from the side to move's view, in centipawns
+JUNGLE_API int  jungle_board_evaluate(jungle_board* b);
+// 0 = game on, -1 = the side to move has lost, 1 = it has won
+JUNGLE_API int  jungle_board_game_over(const jungle_board* b);
+JUNGLE_API int  jungle_board_is_repetition(const jungle_board* b);
+
+JUNGLE_API int      jungle_move_str(uint16_t move, char buf[5]);          // "a3a4" / "0000"
+JUNGLE_API uint16_t jungle_move_parse(const char* s);                     // JUNGLE_MOVE_NONE if malformed
+
+// ========================================================================
+//  Search
+// ========================================================================
+typedef struct jungle_limits {
+    int       depth;            // 0 = none
+    int64_t   movetime;         // ms, 0 = none
+    int64_t   nodes;            // 0 = none
+    int64_t   time[2];          // remaining clock Light / Dark, ms
+    int64_t   inc[2];
+    int       movestogo;
+    int       infinite;         // until jungle_search_stop
+    const uint16_t* searchmoves;    // root moves to consider, NULL = all
+    int       num_searchmoves;
+} jungle_limits;
+
+typedef struct jungle_info {
+    int       depth;
+    int       seldepth;
+    int       multipv;          // 1.. with MultiPV > 1, else 0
+    int       score;            // cp; mate in n plies = +-(JUNGLE_SCORE_MATE - n)
+    int64_t   nodes;
+    int64_t   time_ms;
+    int       hashfull;         // per mille
+    int       pv_len;
+    const uint16_t* pv;
+} jungle_info;
+
+#define JUNGLE_SCORE_MATE 29000    // scores within 128 of it are mates
+
+// Called on the search thread; the info and its pv only live for the call
+typedef void (*jungle_info_fn)(void* user, const jungle_info* info);
+typedef void (*jungle_done_fn)(void* user, uint16_t best, uint16_t ponder, int score);
+
+JUNGLE_API jungle_search* jungle_search_new(int hash_mb, int threads);
+JUNGLE_API void jungle_search_free(jungle_search* s);      // stops a running search first
+
+// The calls below wait for a running search to finish, except stop / running
+JUNGLE_API void jungle_search_set_position(jungle_search* s, const jungle_board* b);
+JUNGLE_API void jungle_search_new_game(jungle_search* s);
+JUNGLE_API void jungle_search_set_hash(jungle_search* s, int mb);
+JUNGLE_API void jungle_search_set_threads(jungle_search* s, int threads);
+JUNGLE_API void jungle_search_set_multipv(jungle_search* s, int lines);
+
+// Starts a search on its own thread and returns once it runs; on_info and
+// on_done may be NULL. Returns 0 if a search is already running.
+JUNGLE_API int      jungle_search_start(jungle_search* s, const jungle_limits* limits,
+                                        jungle_info_fn on_info, jungle_done_fn on_done, void* user);
+JUNGLE_API void     jungle_search_stop(jungle_search* s);  // returns at once; the search ends soon after
+JUNGLE_API int      jungle_search_running(const jungle_search* s);
+// Waits for the search (on_done has returned); the best move, MOVE_NONE if none ran
+JUNGLE_API uint16_t jungle_search_wait(jungle_search* s);
+JUNGLE_API uint16_t jungle_search_ponder_move(const jungle_search* s);
+JUNGLE_API int      jungle_search_score(const jungle_search* s);
+JUNGLE_API int64_t  jungle_search_nodes(const jungle_search* s);
+
+#ifdef __cplusplus
+}
+#endif
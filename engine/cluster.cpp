@@ -0,0 +1,439 @@
+#include "cluster.h"
+#include "net.h"
+#include "tablebase.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+// ========================================================================
+//  Messages
+// ========================================================================
+enum MsgType : uint32_t {
+    MSG_HELLO = 1,      // worker -> coordinator: version, threads
+    MSG_SEARCH,         // flags, limits, share depth, searchmoves, position
+    MSG_RESULT,         // best move, score, nodes, selDepth, PV
+    MSG_GAME,           // self-play game: index and options
+    MSG_GAME_RESULT,    // result for Light, samples
+    MSG_TT,             // TTRecords, both ways
+};
+
+constexpr uint32_t CLUSTER_VERSION   = 1;
+constexpr uint32_t MAX_MESSAGE       = 64u << 20;
+constexpr uint8_t  JOB_NEW_GAME      = 1;       // clear TT and history first
+constexpr size_t   MAX_SHARE         = 1 << 16; // TT records per message
+constexpr int      SHARE_INTERVAL_MS = 1000;
+
+class WireOut {
+public:
+    std::vector<uint8_t> buf;
+
+    template <typename T> void put(const T& v) { putBytes(&v, sizeof(v)); }
+    void putBytes(const void* p, size_t n) {
+        const uint8_t* b = (const uint8_t*)p;
+        buf.insert(buf.end(), b, b + n);
+    }
+};
+
+// Reads past the end give zeros and clear `ok`
+class WireIn {
+public:
+    explicit WireIn(const std::vector<uint8_t>& b) : p(b.data()), end(b.data() + b.size()) {}
+    bool ok = true;
+
+    template <typename T> T get() { T v; getBytes(&v, sizeof(v)); return v; }
+    void getBytes(void* out, size_t n) {
+        if ((size_t)(end - p) < n) { ok = false; memset(out, 0, n); return; }
+        memcpy(out, p, n);
+        p += n;
+    }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+// One peer. Sends are serialised: the job thread, the TT sharer and the
+// coordinator's forwarding all write to the same socket.
+class Connection {
+public:
+    Socket sock;
+
+    bool send(uint32_t type, const WireOut& msg) {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        uint32_t hdr[2] = { type, (uint32_t)msg.buf.size() };
+        return sock.sendAll(hdr, sizeof(hdr)) && sock.sendAll(msg.buf.data(), msg.buf.size());
+    }
+    bool recv(uint32_t& type, std::vector<uint8_t>& payload) {
+        uint32_t hdr[2];
+        if (!sock.recvAll(hdr, sizeof(hdr)) || hdr[1] > MAX_MESSAGE) return false;
+        type = hdr[0];
+        payload.resize(hdr[1]);
+        return hdr[1] == 0 || sock.recvAll(payload.data(), hdr[1]);
+    }
+
+private:
+    std::mutex sendMutex;
+};
+
+// ========================================================================
+//  Positions
+// ========================================================================
+// The board after the last irreversible move plus the moves since: the
+// receiver replays them and has every position repetition detection
+// looks at. The game ply is not sent (workers count from 0).
+static void putPosition(WireOut& w, const Board& b) {
+    Board base = b;
+    int back = std::min({ (int)b.halfmove, b.ply, b.histLen - 1 });
+    std::vector<Move> moves(back);
+    for (int i = back - 1; i >= 0; i--) {
+        moves[i] = base.undoStack[base.ply - 1].move;
+        base.unmakeMove();
+    }
+    PackedPos p;
+    packPosition(base, 0, 0, p);
+    p.ply = 0;
+    w.put(p);
+    w.put((uint16_t)base.halfmove);
+    w.put((uint16_t)moves.size());
+    for (Move m : moves) w.put(m);
+}
+
+static bool getPosition(WireIn& r, Board& b) {
+    PackedPos p = r.get<PackedPos>();
+    uint16_t halfmove = r.get<uint16_t>();
+    uint16_t n = r.get<uint16_t>();
+    if (!r.ok || !unpackPosition(p, b)) return false;
+    b.halfmove = halfmove;
+    for (int i = 0; i < n; i++) {
+        Move m = r.get<Move>();
+        if (!r.ok || !b.isLegal(m)) return false;
+        b.makeMove(m);
+    }
+    return true;
+}
+
+// ========================================================================
+//  Worker
+// ========================================================================
+// `cursor` carries over between the shares of one search
+static void shareEntries(Search& s, Connection& c, int minDepth, size_t& cursor) {
+    std::vector<TTRecord> recs;
+    s.hashTable().exportEntries(minDepth, MAX_SHARE, cursor, recs);
+    if (recs.empty()) return;
+    WireOut w;
+    w.putBytes(recs.data(), recs.size() * sizeof(TTRecord));
+    c.send(MSG_TT, w);
+}
+
+static void workerSearch(Search& s, Connection& c, std::vector<uint8_t> payload) {
+    WireIn r(payload);
+    uint8_t flags = r.get<uint8_t>();
+    SearchLimits limits;
+    limits.depth    = r.get<int32_t>();
+    limits.nodes    = r.get<int64_t>();
+    limits.movetime = r.get<int64_t>();
+    int shareDepth  = r.get<int32_t>();
+    uint16_t n = r.get<uint16_t>();
+    for (int i = 0; i < n && r.ok; i++) limits.searchMoves.push_back(r.get<Move>());
+    Board b;
+    bool ok = r.ok && getPosition(r, b);
+
+    if (flags & JOB_NEW_GAME) s.newGame();
+    Move best = MOVE_NONE;
+    RootLine line{};
+    if (ok) {
+        s.board = b;
+        // Deep entries go out while the search runs, and once more at the end
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool done = false;
+        std::thread sharer;
+        size_t shareCursor = 0;
+        if (shareDepth > 0)
+            sharer = std::thread([&]() {
+                std::unique_lock<std::mutex> lock(mtx);
+                while (!cv.wait_for(lock, std::chrono::milliseconds(SHARE_INTERVAL_MS),
+                                    [&] { return done; })) {
+                    lock.unlock();
+                    shareEntries(s, c, shareDepth, shareCursor);
+                    lock.lock();
+                }
+            });
+        best = s.think(limits);
+        line = s.bestLine();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            done = true;
+        }
+        cv.notify_all();
+        if (sharer.joinable()) sharer.join();
+        if (shareDepth > 0) shareEntries(s, c, shareDepth, shareCursor);
+    }
+
+    WireOut w;
+    w.put(best);
+    w.put((int32_t)line.score);
+    w.put((int64_t)s.totalNodes());
+    w.put((int32_t)line.selDepth);
+    w.put((uint16_t)line.len);
+    for (int i = 0; i < line.len; i++) w.put(line.pv[i]);
+    c.send(MSG_RESULT, w);
+}
+
+static void workerGame(Search& s, Connection& c, std::vector<uint8_t> payload) {
+    WireIn r(payload);
+    SelfplayOptions opt;
+    int index       = r.get<int32_t>();
+    opt.depth       = r.get<int32_t>();
+    opt.nodes       = r.get<int64_t>();
+    opt.randomPlies = r.get<int32_t>();
+    opt.seed        = r.get<uint64_t>();
+
+    std::vector<PackedPos> out;
+    int result = r.ok ? playSelfplayGame(s, opt, index, out) : 0;
+    WireOut w;
+    w.put((int32_t)result);
+    w.put((uint32_t)out.size());
+    w.putBytes(out.data(), out.size() * sizeof(PackedPos));
+    c.send(MSG_GAME_RESULT, w);
+}
+
+// The reader loop: jobs run on their own thread so that shared TT entries
+// keep arriving during a search. A coordinator that goes away stops the
+// current search (a self-play game is played out first).
+static void serveCoordinator(Search& s, Connection& c) {
+    WireOut hello;
+    hello.put(CLUSTER_VERSION);
+    hello.put((uint32_t)s.threadCount());
+    if (!c.send(MSG_HELLO, hello)) return;
+
+    std::thread job;
+    uint32_t type;
+    std::vector<uint8_t> payload;
+    while (c.recv(type, payload)) {
+        if (type == MSG_TT) {
+            s.hashTable().importEntries((const TTRecord*)payload.data(),
+                                        payload.size() / sizeof(TTRecord));
+            continue;
+        }
+        if (type != MSG_SEARCH && type != MSG_GAME) continue;
+        if (job.joinable()) job.join();     // the coordinator waits for each reply
+        job = std::thread(type == MSG_SEARCH ? workerSearch : workerGame,
+                          std::ref(s), std::ref(c), std::move(payload));
+        payload.clear();
+    }
+    s.stop();
+    if (job.joinable()) job.join();
+}
+
+bool runWorker(Search& s, const WorkerOptions& opt) {
+    Socket listener;
+    if (!listener.listen(opt.port)) {
+        std::printf("info string worker: cannot listen on port %d\n", opt.port);
+        fflush(stdout);
+        return false;
+    }
+    if (!opt.tbPath.empty()) tbInit(opt.tbPath);
+    s.silent = true;
+    std::printf("info string worker listening on port %d (%d threads, %zu MB hash)\n",
+                opt.port, s.threadCount(), s.hashMB());
+    fflush(stdout);
+
+    for (;;) {
+        Connection c;
+        c.sock = listener.accept();
+        if (!c.sock.valid()) continue;
+        std::printf("info string worker: coordinator connected\n");
+        fflush(stdout);
+        serveCoordinator(s, c);
+        std::printf("info string worker: coordinator disconnected\n");
+        fflush(stdout);
+    }
+}
+
+// ========================================================================
+//  Coordinator
+// ========================================================================
+class Cluster {
+public:
+    struct Worker {
+        Connection  conn;
+        std::string name;
+        int         threads = 0;
+        std::atomic<bool> alive{true};     // read by the other workers' forwarding
+    };
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Connects to every reachable worker; false if there is none
+    bool connect(const std::vector<std::string>& addrs) {
+        for (const std::string& a : addrs) {
+            std::string host;
+            int port;
+            std::unique_ptr<Worker> w(new Worker());
+            w->name = a;
+            uint32_t type;
+            std::vector<uint8_t> payload;
+            if (!parseHostPort(a, host, port) || !w->conn.sock.connect(host, port)
+                || !w->conn.recv(type, payload) || type != MSG_HELLO) {
+                std::fprintf(stderr, "worker %s: cannot connect\n", a.c_str());
+                continue;
+            }
+            WireIn r(payload);
+            uint32_t version = r.get<uint32_t>();
+            w->threads = (int)r.get<uint32_t>();
+            if (version != CLUSTER_VERSION) {
+                std::fprintf(stderr, "worker %s: protocol version %u, expected %u\n",
+                             a.c_str(), version, CLUSTER_VERSION);
+                continue;
+            }
+            std::fprintf(stderr, "worker %s: %d threads\n", a.c_str(), w->threads);
+            workers.push_back(std::move(w));
+        }
+        return !workers.empty();
+    }
+
+    // Sends a job to worker `i` and waits for its `replyType` message,
+    // forwarding shared TT entries to the other workers meanwhile. A
+    // failure marks the worker dead.
+    bool request(size_t i, uint32_t type, const WireOut& msg, uint32_t replyType,
+                 std::vector<uint8_t>& reply) {
+        Worker& w = *workers[i];
+        if (w.alive && w.conn.send(type, msg)) {
+            uint32_t t;
+            while (w.conn.recv(t, reply)) {
+                if (t == replyType) return true;
+                if (t != MSG_TT) continue;
+                WireOut fwd;
+                fwd.buf.swap(reply);
+                for (size_t j = 0; j < workers.size(); j++)
+                    if (j != i && workers[j]->alive) workers[j]->conn.send(MSG_TT, fwd);
+            }
+        }
+        if (w.alive) std::fprintf(stderr, "worker %s: connection lost\n", w.name.c_str());
+        w.alive = false;
+        w.conn.sock.shutdown();
+        return false;
+    }
+
+    bool search(size_t i, const Board& b, int depth, const std::vector<Move>& moves,
+                bool newGame, int shareDepth, Move& best, RootLine& line) {
+        WireOut w;
+        w.put((uint8_t)(newGame ? JOB_NEW_GAME : 0));
+        w.put((int32_t)depth);
+        w.put((int64_t)0);              // nodes
+        w.put((int64_t)0);              // movetime
+        w.put((int32_t)shareDepth);
+        w.put((uint16_t)moves.size());
+        for (Move m : moves) w.put(m);
+        putPosition(w, b);
+
+        std::vector<uint8_t> reply;
+        if (!request(i, MSG_SEARCH, w, MSG_RESULT, reply)) return false;
+        WireIn r(reply);
+        best          = r.get<Move>();
+        line.score    = r.get<int32_t>();
+        r.get<int64_t>();               // nodes
+        line.selDepth = r.get<int32_t>();
+        line.len      = std::min<int>(r.get<uint16_t>(), MAX_PLY);
+        for (int k = 0; k < line.len; k++) line.pv[k] = r.get<Move>();
+        return r.ok;
+    }
+
+    std::vector<size_t> alive() const {
+        std::vector<size_t> v;
+        for (size_t i = 0; i < workers.size(); i++)
+            if (workers[i]->alive) v.push_back(i);
+        return v;
+    }
+};
+
+// Each position goes to one worker (like the local threads), or with
+// `split` its root moves are dealt over all workers and the best of their
+// answers is taken; moves of a worker that fails are dealt again.
+int runClusterAnalyze(std::istream& in, const AnalyzeOptions& opt, const ClusterOptions& copt) {
+    Cluster cluster;
+    if (!cluster.connect(copt.workers)) {
+        std::printf("info string analyze: no worker reachable\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    if (!copt.split) {
+        AnalyzeSearchFn search = [&](int slot, const Board& b, Move& best, RootLine& line) {
+            return cluster.search((size_t)slot, b, opt.depth, {}, true, copt.shareDepth, best, line);
+        };
+        int n = (int)cluster.workers.size();
+        return runAnalyzeJobs(in, opt, n, search, std::to_string(n) + " workers");
+    }
+
+    AnalyzeSearchFn search = [&](int, const Board& b, Move& best, RootLine& line) {
+        Move moves[MAX_MOVES];
+        int count = 0;
+        b.generateMoves(moves, count);
+        std::vector<Move> todo(moves, moves + count);
+        bool first = true;
+        best = MOVE_NONE;
+        line.score = -SCORE_INF;
+        while (!todo.empty()) {
+            std::vector<size_t> live = cluster.alive();
+            if (live.empty()) return false;
+            size_t parts = std::min(live.size(), todo.size());
+            std::vector<std::vector<Move>> part(parts);
+            for (size_t k = 0; k < todo.size(); k++) part[k % parts].push_back(todo[k]);
+
+            std::vector<Move> partBest(parts);
+            std::vector<RootLine> partLine(parts);
+            std::vector<char> ok(parts);
+            std::vector<std::thread> threads;
+            for (size_t k = 0; k < parts; k++)
+                threads.emplace_back([&, k]() {
+                    ok[k] = cluster.search(live[k], b, opt.depth, part[k], first, copt.shareDepth,
+                                           partBest[k], partLine[k]);
+                });
+            for (auto& t : threads) t.join();
+
+            todo.clear();
+            for (size_t k = 0; k < parts; k++) {
+                if (!ok[k]) { todo.insert(todo.end(), part[k].begin(), part[k].end()); continue; }
+                if (partBest[k] != MOVE_NONE && partLine[k].score > line.score) {
+                    best = partBest[k];
+                    line = partLine[k];
+                }
+            }
+            first = false;
+        }
+        return best != MOVE_NONE;
+    };
+    return runAnalyzeJobs(in, opt, 1, search,
+                          std::to_string(cluster.workers.size()) + " workers, root moves split");
+}
+
+int64_t runClusterSelfplay(const SelfplayOptions& opt, const ClusterOptions& copt) {
+    Cluster cluster;
+    if (!cluster.connect(copt.workers)) {
+        std::printf("info string selfplay: no worker reachable\n");
+        fflush(stdout);
+        return 0;
+    }
+    SelfplayGameFn play = [&](int slot, int game, std::vector<PackedPos>& out, int& result) {
+        WireOut w;
+        w.put((int32_t)game);
+        w.put((int32_t)opt.depth);
+        w.put((int64_t)opt.nodes);
+        w.put((int32_t)opt.randomPlies);
+        w.put((uint64_t)opt.seed);
+        std::vector<uint8_t> reply;
+        if (!cluster.request((size_t)slot, MSG_GAME, w, MSG_GAME_RESULT, reply)) return false;
+        WireIn r(reply);
+        result = r.get<int32_t>();
+        uint32_t n = r.get<uint32_t>();
+        if (!r.ok || n > reply.size() / sizeof(PackedPos)) return false;
+        out.resize(n);
+        r.getBytes(out.data(), n * sizeof(PackedPos));
+        return r.ok && result >= -1 && result <= 1;
+    };
+    return runSelfplayJobs(opt, (int)cluster.workers.size(), play, "worker");
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "analyze.h"
+#include "selfplay.h"
+#include <string>
+#include <vector>
+
+// ---- Distributed search ----
+// Worker: `jungle worker listen <port>` serves one coordinator at a time
+// with its own searcher (Threads, Hash). Coordinator: analyze / selfplay
+// with `workers host:port,...` give positions, root moves or games to the
+// workers instead of local threads; a worker that drops out has its job
+// moved to the others.
+//
+// Protocol: framed binary messages { uint32 type, uint32 length, payload }
+// in the machines' (little-endian) layout; HELLO carries a version, so both
+// ends must be the same build. A position travels as the board after the
+// last capture (PackedPos) plus the moves since, which keeps the history
+// repetition detection needs. While searching, a worker sends its entries
+// of depth >= the share depth about once a second, and the coordinator
+// forwards them to the other workers.
+struct WorkerOptions {
+    int         port   = 0;
+    std::string tbPath;            // tablebases for self-play adjudication
+};
+
+struct ClusterOptions {
+    std::vector<std::string> workers;  // host:port
+    bool split      = false;    // analyze: deal each position's root moves over all workers
+    int  shareDepth = 8;        // TT entries shared between workers from this depth, 0 = none
+};
+
+// Serves coordinators on `s` until killed; false if the port cannot be opened
+bool runWorker(Search& s, const WorkerOptions& opt);
+
+// analyze / selfplay on remote workers; the options are those of the local
+// commands (threads and hash are the workers' own)
+int     runClusterAnalyze(std::istream& in, const AnalyzeOptions& opt, const ClusterOptions& copt);
+int64_t runClusterSelfplay(const SelfplayOptions& opt, const ClusterOptions& copt);
@@ -0,0 +1,43 @@
+#pragma once
+#include "types.h"
+
+// ---- Evaluation parameters ----
+// Every weight of the handcrafted eval, as one flat vector so the tuner
+// can treat it as such. The eval is linear in these: each position's
+// score is a sum of integer coefficients times parameters (see
+// Board::evalTrace). Defaults are in evalweights.h, which jungle-tune
+// writes back out.
+enum EvalParam {
+    EP_MATERIAL      = 0,                       // [rank], 0 unused
+    EP_ROW           = EP_MATERIAL + 9,         // PST: advancement, by own row
+    EP_COL           = EP_ROW + 9,              // PST: centralisation, by column
+    EP_RAT_WATER     = EP_COL + 7,              // PST: rat in the river, by row
+    EP_JUMP_SQUARE   = EP_RAT_WATER + 9,        // PST: lion / tiger per jump from a square
+    EP_DEN_PROXIMITY = EP_JUMP_SQUARE + 1,      // PST: by land distance 0..8 to the enemy den
+    EP_DEN_NEAR      = EP_DEN_PROXIMITY + 9,    // distance to the enemy den by piece
+                                                // mobility: <= 1, 2, 3, 4-5
+    EP_EG_DEN        = EP_DEN_NEAR + 4,         // endgame den race, distance 0..3
+    EP_TRAP          = EP_EG_DEN + 4,           // [rank] piece on an enemy trap
+    EP_RAT_THREAT    = EP_TRAP + 9,             // our rat vs their elephant:
+                                                // present, within 2, adjacent
+    EP_RAT_DANGER    = EP_RAT_THREAT + 3,       // their rat vs our elephant (subtracted)
+    EP_DEN_SAFETY    = EP_RAT_DANGER + 3,       // enemy piece at distance <= 1, 2, 3
+                                                // from our den (subtracted)
+    EP_PIECE_COUNT   = EP_DEN_SAFETY + 3,       // per piece of advantage
+    NUM_EVAL_PARAMS  = EP_PIECE_COUNT + 1
+};
+
+struct EvalParamGroup {
+    const char* name;
+    int         index;
+    int         count;
+};
+extern const EvalParamGroup EVAL_PARAM_GROUPS[];
+extern const int NUM_EVAL_PARAM_GROUPS;
+
+// Current weights (DEFAULT_EVAL_PARAMS until setEvalParams)
+extern int (&evalParams)[NUM_EVAL_PARAMS];
+
+// Replaces the weights and rebuilds the incremental eval tables. Boards set
+// up before keep stale sums until setFEN / init.
+void setEvalParams(const int* params);
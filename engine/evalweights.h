@@ -0,0 +1,32 @@
+#pragma once
+#include "evalparams.h"
+
+// Handcrafted eval weights, indexed by EvalParam. Written by jungle-tune.
+constexpr int DEFAULT_EVAL_PARAMS[NUM_EVAL_PARAMS] = {
+    // material
+    0, 400, 250, 300, 450, 650, 950, 1050, 1000,
+    // row
+    -5, 0, 5, 15, 25, 35, 55, 85, 120,
+    // col
+    0, 5, 15, 30, 15, 5, 0,
+    // ratWater
+    20, 25, 30, 35, 40, 45, 50, 55, 60,
+    // jumpSquare
+    15,
+    // denProximity
+    130, 115, 100, 85, 70, 55, 40, 25, 10,
+    // denNear
+    250, 120, 60, 20,
+    // egDen
+    320, 240, 160, 80,
+    // trap
+    0, 133, 83, 100, 150, 216, 316, 350, 333,
+    // ratThreat
+    40, 60, 80,
+    // ratDanger
+    30, 40, 60,
+    // denSafety
+    300, 100, 30,
+    // pieceCount
+    30,
+};
@@ -1,4 +1,14 @@
 #include "search.h"
+#include "perft.h"
+#include "bench.h"
+#include "tablebase.h"
+#include "book.h"
+#include "analyze.h"
+#include "selfplay.h"
+#include "output.h"
+#include "cluster.h"
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -8,12 +18,28 @@
 static Search engine;
 static std::atomic<bool> searching(false);
 static std::thread searchThread;
+static std::string tbPath;          // TablebasePath, also where tbgen writes
+static bool ownBook = false;        // OwnBook: play BookFile moves without searching
+static std::atomic<bool> debugMode(false);
+static std::atomic<int64_t> stopStamp(0);   // when "stop" was read, microseconds
 
-static void doSearch(int depth, int64_t movetime, bool infinite) {
+static int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void doSearch(SearchLimits limits) {
     searching = true;
-    Move best = engine.think(depth, movetime, infinite);
-    std::printf("bestmove %s\n", moveToStr(best).c_str());
-    fflush(stdout);
+    Move best = engine.think(limits);
+    Move ponder = engine.ponderMove();
+    // debug on: time from reading "stop" to the answer being queued
+    int64_t stamp = stopStamp.exchange(0);
+    if (debugMode && stamp)
+        outLine("info string stop latency %lld us", (long long)(nowMicros() - stamp));
+    if (ponder != MOVE_NONE)
+        outLine("bestmove %s ponder %s", moveToStr(best).c_str(), moveToStr(ponder).c_str());
+    else
+        outLine("bestmove %s", moveToStr(best).c_str());
     searching = false;
 }
 
@@ -47,71 +73,256 @@ static void cmdPosition(std::istringstream& iss) {
 }
 
 static void cmdGo(std::istringstream& iss) {
-    int depth = 0;
-    int64_t movetime = 0;
-    bool infinite = false;
-    int64_t wtime = 0, btime = 0;
-
+    SearchLimits limits;
     std::string token;
     while (iss >> token) {
-        if (token == "depth")    { iss >> depth; }
-        else if (token == "movetime") { iss >> movetime; }
-        else if (token == "infinite") { infinite = true; }
-        else if (token == "wtime")    { iss >> wtime; }
-        else if (token == "btime")    { iss >> btime; }
+        if (token == "depth")          { iss >> limits.depth; }
+        else if (token == "movetime")  { iss >> limits.movetime; }
+        else if (token == "infinite")  { limits.infinite = true; }
+        else if (token == "ponder")    { limits.ponder = true; }
+        else if (token == "wtime")     { iss >> limits.time[LIGHT]; }
+        else if (token == "btime")     { iss >> limits.time[DARK]; }
+        else if (token == "winc")      { iss >> limits.inc[LIGHT]; }
+        else if (token == "binc")      { iss >> limits.inc[DARK]; }
+        else if (token == "movestogo") { iss >> limits.movestogo; }
+        else if (token == "nodes")     { iss >> limits.nodes; }
+        else if (token == "searchmoves") {
+            // The rest of the line
+            while (iss >> token) {
+                Move m = strToMove(token);
+                if (m != MOVE_NONE) limits.searchMoves.push_back(m);
+            }
+        }
     }
 
-    // Time management: if wtime/btime given, compute movetime
-    if (wtime > 0 || btime > 0) {
-        int64_t ourTime = (engine.board.sideToMove == LIGHT) ? wtime : btime;
-        // Simple: use 1/30 of remaining time, min 100ms
-        movetime = std::max((int64_t)100, ourTime / 30);
-    }
+    // Plain "go": 5 seconds
+    if (limits.depth == 0 && limits.movetime == 0 && limits.nodes == 0 && !limits.hasClock()
+        && !limits.infinite)
+        limits.movetime = 5000;
 
-    if (depth == 0 && movetime == 0 && !infinite) {
-        movetime = 5000; // default 5 seconds
+    // Book move: answer at once
+    if (ownBook && !limits.infinite && !limits.ponder) {
+        Move bm = bookProbe(engine.board);
+        if (bm != MOVE_NONE) {
+            outLine("info string book move %s", moveToStr(bm).c_str());
+            outLine("bestmove %s", moveToStr(bm).c_str());
+            return;
+        }
     }
 
-    // Launch search in a separate thread so we can process "stop"
+    // Launch search in a separate thread so we can process "stop"; return
+    // once it has started so that a stop right behind "go" is not lost
+    if (searchThread.joinable()) searchThread.join();
+    if (limits.ponder) engine.startPonder();
+    int64_t started = engine.searchCount();
+    stopStamp = 0;
+    searchThread = std::thread(doSearch, limits);
+    while (engine.searchCount() == started) std::this_thread::yield();
+}
+
+static void stopSearch() {
+    if (searching) stopStamp = nowMicros();
+    engine.stop();
     if (searchThread.joinable()) searchThread.join();
-    searchThread = std::thread(doSearch, depth, movetime, infinite);
 }
 
-int main() {
-    initTables();
+// bench [depth] [threads] [hash]
+static void cmdBench(std::istringstream& iss) {
+    int depth = BENCH_DEPTH, threads = BENCH_THREADS, hash = BENCH_HASH;
+    iss >> depth >> threads >> hash;
+    runBench(engine, depth, threads, (size_t)hash);
+}
+
+// Coordinator options shared by analyze and selfplay: workers <host:port,...>
+// [share <depth>]; false if `tok` is none of them
+static bool parseClusterOption(const std::string& tok, std::istringstream& iss, ClusterOptions& copt) {
+    if (tok == "workers") {
+        std::string list, addr;
+        iss >> list;
+        std::istringstream ls(list);
+        while (std::getline(ls, addr, ','))
+            if (!addr.empty()) copt.workers.push_back(addr);
+        return true;
+    }
+    if (tok == "share") { iss >> copt.shareDepth; return true; }
+    return false;
+}
+
+// analyze [file] [depth <n>] [threads <t>] [hash <mb>] [workers <list> [split]
+// [share <d>]], "--depth" etc. also accepted. Without a file the command-line
+// mode reads stdin.
+static void cmdAnalyze(std::istringstream& iss, bool fromStdin) {
+    AnalyzeOptions opt;
+    ClusterOptions copt;
+    opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string tok, file;
+    bool badOption = false;
+    while (iss >> tok && !badOption) {
+        bool dashed = tok.compare(0, 2, "--") == 0;
+        if (dashed) tok = tok.substr(2);
+        if (tok == "depth")        iss >> opt.depth;
+        else if (tok == "threads") iss >> opt.threads;
+        else if (tok == "hash")    iss >> opt.hashMB;
+        else if (tok == "split")   copt.split = true;
+        else if (parseClusterOption(tok, iss, copt)) {}
+        else if (!dashed)          file = tok;
+        else                       badOption = true;    // not a file name
+    }
+    auto run = [&](std::istream& in) {
+        if (copt.workers.empty()) runAnalyze(in, opt);
+        else                      runClusterAnalyze(in, opt, copt);
+    };
+    if (file.empty() || badOption) {
+        if (fromStdin && !badOption) run(std::cin);
+        else std::printf("info string usage: analyze <file> [depth <n>] [threads <t>] [hash <mb>]\n");
+        fflush(stdout);
+        return;
+    }
+    std::ifstream in(file);
+    if (!in) {
+        std::printf("info string cannot open %s\n", file.c_str());
+        fflush(stdout);
+        return;
+    }
+    run(in);
+}
+
+// selfplay <out.bin> [games <n>] [nodes <n> | depth <n>] [threads <t>]
+//          [hash <mb>] [random <plies>] [seed <s>] [workers <list>], "--games"
+//          etc. also accepted
+static void cmdSelfplay(std::istringstream& iss) {
+    SelfplayOptions opt;
+    ClusterOptions copt;
+    opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string tok;
+    bool badOption = false;
+    while (iss >> tok && !badOption) {
+        bool dashed = tok.compare(0, 2, "--") == 0;
+        if (dashed) tok = tok.substr(2);
+        if (tok == "games")        iss >> opt.games;
+        else if (tok == "nodes")   iss >> opt.nodes;
+        else if (tok == "depth")   iss >> opt.depth;
+        else if (tok == "threads") iss >> opt.threads;
+        else if (tok == "hash")    iss >> opt.hashMB;
+        else if (tok == "random")  iss >> opt.randomPlies;
+        else if (tok == "seed")    iss >> opt.seed;
+        else if (parseClusterOption(tok, iss, copt)) {}
+        else if (!dashed)          opt.output = tok;
+        else                       badOption = true;    // not a file name
+    }
+    if (opt.output.empty() || badOption) {
+        std::printf("info string usage: selfplay <out.bin> [games <n>] [nodes <n> | depth <n>] ...\n");
+        fflush(stdout);
+        return;
+    }
+    if (copt.workers.empty()) runSelfplay(opt);
+    else                      runClusterSelfplay(opt, copt);
+}
+
+// worker [listen] <port> [threads <t>] [hash <mb>] [tbpath <dir>], "--listen"
+// etc. also accepted: serves coordinators until killed
+static void cmdWorker(std::istringstream& iss) {
+    WorkerOptions opt;
+    int threads = 1;
+    size_t hashMB = 128;
+    std::string tok;
+    while (iss >> tok) {
+        if (tok.compare(0, 2, "--") == 0) tok = tok.substr(2);
+        if (tok == "listen")       iss >> opt.port;
+        else if (tok == "threads") iss >> threads;
+        else if (tok == "hash")    iss >> hashMB;
+        else if (tok == "tbpath")  iss >> opt.tbPath;
+        else                       opt.port = std::atoi(tok.c_str());
+    }
+    if (opt.port <= 0 || opt.port > 65535) {
+        std::printf("info string usage: worker listen <port> [threads <t>] [hash <mb>] [tbpath <dir>]\n");
+        fflush(stdout);
+        return;
+    }
+    engine.resizeTT(hashMB);
+    engine.setThreads(std::max(1, threads));
+    runWorker(engine, opt);
+}
+
+// datadump <file> [count]
+static void cmdDataDump(std::istringstream& iss) {
+    std::string file;
+    int64_t count = 10;
+    iss >> file >> count;
+    dumpSelfplayData(file, count);
+}
+
+int main(int argc, char* argv[]) {
     engine.init(64); // 64 MB TT
     engine.board.init();
 
+    // Command-line mode: "jungle bench 12 1 16",
+    // "jungle analyze --depth 10 --threads 8 < fens.txt" or
+    // "jungle --worker --listen 4000" runs one command and exits
+    if (argc > 1) {
+        std::string line;
+        for (int i = 1; i < argc; i++) line += std::string(i > 1 ? " " : "") + argv[i];
+        std::istringstream iss(line);
+        std::string cmd;
+        iss >> cmd;
+        if (cmd.compare(0, 2, "--") == 0) cmd = cmd.substr(2);
+        if (cmd == "bench") cmdBench(iss);
+        else if (cmd == "worker") cmdWorker(iss);
+        else if (cmd == "analyze") cmdAnalyze(iss, true);
+        else if (cmd == "selfplay") cmdSelfplay(iss);
+        else if (cmd == "datadump") cmdDataDump(iss);
+        engine.destroy();
+        return 0;
+    }
+
+    // Protocol lines go through the writer thread; the tool commands below
+    // print directly, after the queue has drained
+    outStart();
     std::string line;
     while (std::getline(std::cin, line)) {
         std::istringstream iss(line);
         std::string cmd;
         iss >> cmd;
 
+        if (cmd == "stop") {
+            stopSearch();
+            continue;
+        }
+        if (cmd == "ponderhit") {
+            engine.ponderhit();
+            continue;
+        }
+        outFlush();
+
         if (cmd == "jcei" || cmd == "uci") {
-            std::printf("id name JungleEngine 0.1\n");
-            std::printf("id author Claude\n");
-            std::printf("option name Hash type spin default 128 min 1 max 4096\n");
-            std::printf("jceiok\n");
-            fflush(stdout);
+            outLine("id name JungleEngine 0.1");
+            outLine("id author Claude");
+            outLine("option name Hash type spin default 128 min 1 max 4096");
+            outLine("option name Threads type spin default 1 min 1 max 256");
+            outLine("option name EvalFile type string default <empty>");
+            outLine("option name EvalCache type spin default 4 min 1 max 1024");
+            outLine("option name TablebasePath type string default <empty>");
+            outLine("option name MultiPV type spin default 1 min 1 max 64");
+            outLine("option name OwnBook type check default false");
+            outLine("option name BookFile type string default <empty>");
+            outLine("jceiok");
         }
         else if (cmd == "isready") {
-            std::printf("readyok\n");
-            fflush(stdout);
+            outLine("readyok");
+        }
+        else if (cmd == "debug") {
+            std::string tok;
+            iss >> tok;
+            debugMode = (tok != "off");
         }
         else if (cmd == "position") {
+            stopSearch();
             cmdPosition(iss);
         }
         else if (cmd == "go") {
             cmdGo(iss);
         }
-        else if (cmd == "stop") {
-            engine.stop();
-            if (searchThread.joinable()) searchThread.join();
-        }
         else if (cmd == "quit" || cmd == "exit") {
-            engine.stop();
-            if (searchThread.joinable()) searchThread.join();
             break;
         }
         else if (cmd == "display" || cmd == "d") {
@@ -119,13 +330,36 @@ int main() {
             fflush(stdout);
         }
         else if (cmd == "perft") {
-            int d = 1;
-            iss >> d;
-            auto t0 = std::chrono::steady_clock::now();
-            uint64_t n = engine.board.perft(d);
-            auto t1 = std::chrono::steady_clock::now();
-            int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
-            std::printf("perft(%d) = %llu  (%lld ms)\n", d, (unsigned long long)n, (long long)ms);
+            // perft <n> [threads <t>] [hash <mb>] [divide]
+            PerftOptions opt;
+            iss >> opt.depth;
+            std::string tok;
+            while (iss >> tok) {
+                if (tok == "threads")     iss >> opt.threads;
+                else if (tok == "hash")   iss >> opt.hashMB;
+                else if (tok == "divide") opt.divide = true;
+            }
+            runPerft(engine.board, opt);
+        }
+        else if (cmd == "bench") {
+            stopSearch();
+            cmdBench(iss);
+        }
+        else if (cmd == "analyze") {
+            cmdAnalyze(iss, false);
+        }
+        else if (cmd == "selfplay") {
+            cmdSelfplay(iss);
+        }
+        else if (cmd == "datadump") {
+            cmdDataDump(iss);
+        }
+        else if (cmd == "stats") {
+            // Counters of the last search, summed over threads
+            if (SEARCH_STATS_ENABLED)
+                std::printf("%s\n", engine.searchStats().format(false).c_str());
+            else
+                std::printf("stats not compiled in: build jungle-stats (make stats)\n");
             fflush(stdout);
         }
         else if (cmd == "eval") {
@@ -145,7 +379,9 @@ int main() {
             fflush(stdout);
         }
         else if (cmd == "setoption") {
-            // Parse "setoption name Hash value 256"
+            // Options resize or reload state the search threads read: end
+            // a running search first. Parse "setoption name Hash value 256"
+            stopSearch();
             std::string tok;
             std::string name, value;
             while (iss >> tok) {
@@ -154,18 +390,96 @@ int main() {
             }
             if (name == "Hash") {
                 int mb = std::stoi(value);
-                engine.destroy();
-                engine.init((size_t)mb);
+                engine.resizeTT((size_t)mb);
+            }
+            else if (name == "Threads") {
+                engine.setThreads(std::stoi(value));
+            }
+            else if (name == "EvalCache") {
+                engine.resizeEvalCache((size_t)std::stoi(value));
+            }
+            else if (name == "TablebasePath") {
+                tbPath = (value == "<empty>") ? "" : value;
+                int n = 0;
+                if (tbPath.empty()) tbFree();
+                else n = tbInit(tbPath);
+                outLine("info string Tablebases: %d files, up to %d pieces", n, tbMaxPieces);
+            }
+            else if (name == "MultiPV") {
+                engine.multiPV = std::max(1, std::min(64, std::stoi(value)));
+            }
+            else if (name == "OwnBook") {
+                ownBook = (value == "true");
             }
+            else if (name == "BookFile") {
+                if (value.empty() || value == "<empty>") {
+                    bookFree();
+                } else {
+                    outLine("info string BookFile %s %s", value.c_str(),
+                            bookLoad(value) ? "loaded" : "could not be loaded");
+                }
+            }
+            else if (name == "EvalFile") {
+                if (value.empty() || value == "<empty>") {
+                    nnueUnload();
+                    engine.clearEvals();
+                    outLine("info string EvalFile unloaded, using handcrafted eval");
+                } else if (nnueLoad(value)) {
+                    engine.board.refreshAccumulator();
+                    engine.clearEvals();
+                    outLine("info string EvalFile %s loaded", value.c_str());
+                } else {
+                    outLine("info string EvalFile %s could not be loaded", value.c_str());
+                }
+            }
+        }
+        else if (cmd == "book") {
+            // book <games.txt> <out.bin> [maxPly]
+            std::string input, output;
+            int maxPly = 16;
+            iss >> input >> output >> maxPly;
+            bookBuild(input, output, maxPly);
+        }
+        else if (cmd == "tbgen") {
+            // tbgen <maxPieces | material>, written to TablebasePath; loads
+            // the new tables, which a running search may be probing
+            stopSearch();
+            std::string spec;
+            iss >> spec;
+            tbGenerate(spec.empty() ? "3" : spec, tbPath);
+            fflush(stdout);
+        }
+        else if (cmd == "savehash") {
+            // savehash <file> [depth <n>]: only entries searched to depth n or more
+            stopSearch();
+            std::string file, tok, error;
+            int minDepth = INT_MIN;
+            iss >> file;
+            while (iss >> tok)
+                if (tok == "depth") iss >> minDepth;
+            int64_t n = engine.hashTable().save(file, minDepth, error);
+            if (n < 0) outLine("info string savehash: %s", error.c_str());
+            else       outLine("info string savehash: %lld entries written to %s", (long long)n, file.c_str());
+        }
+        else if (cmd == "loadhash") {
+            // loadhash <file>: merged into the current table
+            stopSearch();
+            std::string file, error;
+            iss >> file;
+            int64_t n = engine.hashTable().load(file, error);
+            if (n < 0) outLine("info string loadhash: %s", error.c_str());
+            else       outLine("info string loadhash: %lld entries read from %s", (long long)n, file.c_str());
         }
         else if (cmd == "newgame" || cmd == "ucinewgame") {
-            engine.destroy();
-            engine.init(64);
+            stopSearch();
+            engine.newGame();
             engine.board.init();
-            engine.clearHistory();
         }
     }
 
+    // quit or end of input: a running search answers before we exit
+    stopSearch();
+    outStop();
     engine.destroy();
     return 0;
 }
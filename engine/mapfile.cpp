@@ -0,0 +1,49 @@
+#include "mapfile.h"
+#include <cstdio>
+#include <cstdlib>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#if defined(_WIN32)
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long len = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    void* buf = len > 0 ? std::malloc((size_t)len) : nullptr;
+    bool ok = buf && std::fread(buf, 1, (size_t)len, f) == (size_t)len;
+    std::fclose(f);
+    if (!ok) { std::free(buf); return false; }
+    data = buf;
+    size = (size_t)len;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data = p;
+    size = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (!data) return;
+#if defined(_WIN32)
+    std::free(const_cast<void*>(data));
+#else
+    munmap(const_cast<void*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
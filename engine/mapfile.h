@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// ---- Read-only file mapping ----
+// mmap on POSIX; on Windows the file is read into memory instead.
+struct MappedFile {
+    const void* data = nullptr;
+    size_t      size = 0;
+
+    bool open(const std::string& path);
+    void close();
+};
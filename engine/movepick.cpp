@@ -0,0 +1,182 @@
+#include "movepick.h"
+#include "searchstats.h"
+#include "tables.h"
+
+// ========================================================================
+//  Construction
+// ========================================================================
+MovePicker::MovePicker(const Board& b, Move tt, const Move* killers, Move cm,
+                       const ButterflyHistory& hist, const CaptureHistory& capHist,
+                       const PieceToHistory* c1, const PieceToHistory* c2)
+    : board(b), history(&hist), captureHistory(&capHist), cont1(c1), cont2(c2),
+      ttMove(tt), cur(0), end(0), numBad(0), badCur(0) {
+    killer1 = killers ? killers[0] : MOVE_NONE;
+    killer2 = killers ? killers[1] : MOVE_NONE;
+    counter = cm;
+    oppDen  = (b.sideToMove == LIGHT) ? DEN_DARK_SQ : DEN_LIGHT_SQ;
+    denFrom = 0;
+    stage   = (ttMove != MOVE_NONE && b.isLegal(ttMove)) ? STAGE_TT : STAGE_DEN_INIT;
+    if (stage != STAGE_TT) ttMove = MOVE_NONE;
+    if (counter == killer1 || counter == killer2) counter = MOVE_NONE;
+}
+
+MovePicker::MovePicker(const Board& b, const CaptureHistory* capHist)
+    : board(b), history(nullptr), captureHistory(capHist), cont1(nullptr), cont2(nullptr),
+      ttMove(MOVE_NONE),
+      killer1(MOVE_NONE), killer2(MOVE_NONE), counter(MOVE_NONE),
+      oppDen(-1), stage(QS_CAPTURE_INIT), cur(0), end(0), numBad(0), badCur(0),
+      denFrom(0) {}
+
+// ========================================================================
+//  Helpers
+// ========================================================================
+// MVV-LVA, then capture history: worth up to about one victim step
+void MovePicker::scoreCaptures() {
+    for (int i = cur; i < end; i++) {
+        int from = moveFrom(moves[i]), to = moveTo(moves[i]);
+        int victim   = abs(board.squares[to]);
+        int attacker = board.squares[from];
+        scores[i] = MATERIAL_VAL[victim] * 10 - MATERIAL_VAL[abs(attacker)];
+        if (captureHistory)
+            scores[i] += (*captureHistory)[pieceIndex(attacker)][to][victim] / 32;
+    }
+}
+
+// Selection pick: captures are few, and usually only the first is needed
+Move MovePicker::pickBestCapture() {
+    int best = cur;
+    for (int i = cur + 1; i < end; i++)
+        if (scores[i] > scores[best]) best = i;
+    std::swap(moves[cur], moves[best]);
+    std::swap(scores[cur], scores[best]);
+    return moves[cur++];
+}
+
+bool MovePicker::isSpecial(Move m) const {
+    return m == ttMove || m == killer1 || m == killer2 || m == counter
+        || moveTo(m) == oppDen;
+}
+
+// ========================================================================
+//  next()
+// ========================================================================
+Move MovePicker::next() {
+    switch (stage) {
+    case STAGE_TT:
+        stage = STAGE_DEN_INIT;
+        return ttMove;
+
+    case STAGE_DEN_INIT:
+        // The enemy den is always empty and surrounded by land, so any of
+        // our pieces next to it can step in
+        denFrom = stepBB[oppDen] & board.occ[board.sideToMove];
+        stage = STAGE_DEN;
+        [[fallthrough]];
+
+    case STAGE_DEN:
+        while (denFrom) {
+            Move m = encodeMove(popLSB(denFrom), oppDen);
+            if (m != ttMove) return m;
+        }
+        stage = STAGE_CAPTURE_INIT;
+        [[fallthrough]];
+
+    case STAGE_CAPTURE_INIT:
+        { STAT_TIMER(ST_GEN_CALLS, ST_GEN_NS); board.generateCaptures(moves, end); }
+        cur = 0;
+        scoreCaptures();
+        stage = STAGE_CAPTURE;
+        [[fallthrough]];
+
+    case STAGE_CAPTURE:
+        while (cur < end) {
+            Move m = pickBestCapture();
+            if (m == ttMove) continue;
+            if (board.see(m) < 0) { badCaptures[numBad++] = m; continue; }
+            return m;
+        }
+        stage = STAGE_KILLER1;
+        [[fallthrough]];
+
+    case STAGE_KILLER1:
+        stage = STAGE_KILLER2;
+        if (killer1 != ttMove && board.isLegal(killer1)
+            && board.squares[moveTo(killer1)] == 0 && moveTo(killer1) != oppDen)
+            return killer1;
+        [[fallthrough]];
+
+    case STAGE_KILLER2:
+        stage = STAGE_COUNTER;
+        if (killer2 != ttMove && killer2 != killer1 && board.isLegal(killer2)
+            && board.squares[moveTo(killer2)] == 0 && moveTo(killer2) != oppDen)
+            return killer2;
+        [[fallthrough]];
+
+    case STAGE_COUNTER:
+        stage = STAGE_QUIET_INIT;
+        if (counter != ttMove && board.isLegal(counter)
+            && board.squares[moveTo(counter)] == 0 && moveTo(counter) != oppDen)
+            return counter;
+        [[fallthrough]];
+
+    case STAGE_QUIET_INIT: {
+        { STAT_TIMER(ST_GEN_CALLS, ST_GEN_NS); board.generateQuiets(moves, end); }
+        cur = 0;
+        // Score by history, then insertion-sort only the moves with a
+        // positive score; the rest keep generation order at the back
+        int n = 0;
+        for (int i = 0; i < end; i++) {
+            if (isSpecial(moves[i])) continue;
+            int from = moveFrom(moves[i]), to = moveTo(moves[i]);
+            int pc = pieceIndex(board.squares[from]);
+            moves[n] = moves[i];
+            scores[n] = (*history)[from][to];
+            if (cont1) scores[n] += (*cont1)[pc][to];
+            if (cont2) scores[n] += (*cont2)[pc][to];
+            n++;
+        }
+        end = n;
+        for (int i = 0, sorted = 0; i < end; i++) {
+            if (scores[i] <= 0) continue;
+            Move m = moves[i];
+            int s = scores[i];
+            moves[i] = moves[sorted];
+            scores[i] = scores[sorted];
+            int j = sorted++;
+            for (; j > 0 && scores[j - 1] < s; j--) {
+                moves[j] = moves[j - 1];
+                scores[j] = scores[j - 1];
+            }
+            moves[j] = m;
+            scores[j] = s;
+        }
+        stage = STAGE_QUIET;
+        [[fallthrough]];
+    }
+
+    case STAGE_QUIET:
+        if (cur < end) return moves[cur++];
+        stage = STAGE_BAD_CAPTURE;
+        [[fallthrough]];
+
+    case STAGE_BAD_CAPTURE:
+        if (badCur < numBad) return badCaptures[badCur++];
+        stage = STAGE_DONE;
+        return MOVE_NONE;
+
+    case QS_CAPTURE_INIT:
+        { STAT_TIMER(ST_GEN_CALLS, ST_GEN_NS); board.generateCaptures(moves, end); }
+        cur = 0;
+        scoreCaptures();
+        stage = QS_CAPTURE;
+        [[fallthrough]];
+
+    case QS_CAPTURE:
+        if (cur < end) return pickBestCapture();
+        stage = STAGE_DONE;
+        return MOVE_NONE;
+
+    default:
+        return MOVE_NONE;
+    }
+}
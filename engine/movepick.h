@@ -0,0 +1,70 @@
+#pragma once
+#include "board.h"
+
+// ---- History tables ----
+// All int16, updated with a gravity rule: v += bonus - v * |bonus| / MAX,
+// so values stay within +-HISTORY_MAX and saturated entries move least.
+constexpr int HISTORY_MAX = 16384;
+
+inline void updateHistory(int16_t& v, int bonus) {
+    bonus = std::max(-HISTORY_MAX, std::min(HISTORY_MAX, bonus));
+    v = (int16_t)(v + bonus - v * abs(bonus) / HISTORY_MAX);
+}
+
+// Piece index for move histories: Light rat..elephant = 0..7, Dark = 8..15
+inline int pieceIndex(int piece) { return piece > 0 ? piece - 1 : 7 - piece; }
+
+using ButterflyHistory = int16_t[NUM_SQ][NUM_SQ];                 // [from][to]
+using PieceToHistory   = int16_t[16][NUM_SQ];                     // [piece][to]
+using CaptureHistory   = int16_t[16][NUM_SQ][NUM_PIECE_TYPES];    // [piece][to][captured rank]
+
+// ---- Staged move picker ----
+// Main search:  TT move -> den entries -> captures (MVV-LVA + capture
+//               history) -> killers -> counter move -> quiets (butterfly +
+//               1- and 2-ply continuation history, partially sorted) ->
+//               captures that lose material by SEE
+// Quiescence:   captures only
+// Moves are generated lazily, so a cutoff on the TT move or a capture
+// never pays for quiet generation and scoring.
+class MovePicker {
+public:
+    // Main search. cont1 / cont2: continuation tables of the moves 1 and 2
+    // plies back, nullptr when there is none.
+    MovePicker(const Board& b, Move ttMove, const Move* killers, Move counter,
+               const ButterflyHistory& history, const CaptureHistory& captureHistory,
+               const PieceToHistory* cont1, const PieceToHistory* cont2);
+    // Quiescence (captures only)
+    explicit MovePicker(const Board& b, const CaptureHistory* captureHistory = nullptr);
+
+    // Next move to try, MOVE_NONE when exhausted
+    Move next();
+
+private:
+    enum Stage {
+        STAGE_TT, STAGE_DEN_INIT, STAGE_DEN, STAGE_CAPTURE_INIT, STAGE_CAPTURE,
+        STAGE_KILLER1, STAGE_KILLER2, STAGE_COUNTER,
+        STAGE_QUIET_INIT, STAGE_QUIET, STAGE_BAD_CAPTURE, STAGE_DONE,
+        QS_CAPTURE_INIT, QS_CAPTURE
+    };
+
+    const Board& board;
+    const ButterflyHistory* history;    // for the side to move
+    const CaptureHistory*   captureHistory;
+    const PieceToHistory*   cont1;
+    const PieceToHistory*   cont2;
+    Move  ttMove;
+    Move  killer1, killer2, counter;
+    int   oppDen;
+    int   stage;
+
+    Move  moves[MAX_MOVES];
+    int   scores[MAX_MOVES];
+    int   cur, end;
+    Move  badCaptures[MAX_MOVES];   // deferred from the capture stage
+    int   numBad, badCur;
+    Bitboard denFrom;               // our pieces next to the enemy den
+
+    void scoreCaptures();
+    Move pickBestCapture();
+    bool isSpecial(Move m) const;   // already tried in an earlier stage
+};
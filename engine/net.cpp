@@ -0,0 +1,164 @@
+#include "net.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socklen_t = int;
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// ========================================================================
+//  Platform
+// ========================================================================
+#if defined(_WIN32)
+static bool netInit() {
+    static bool ok = [] { WSADATA w; return WSAStartup(MAKEWORD(2, 2), &w) == 0; }();
+    return ok;
+}
+static void closeFd(intptr_t fd) { closesocket((SOCKET)fd); }
+#else
+static bool netInit() { return true; }
+static void closeFd(intptr_t fd) { ::close((int)fd); }
+#endif
+
+// Messages are small request / reply pairs: send them at once
+static void setNoDelay(intptr_t fd) {
+    int one = 1;
+    setsockopt((int)fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+}
+
+// ========================================================================
+//  Socket
+// ========================================================================
+Socket& Socket::operator=(Socket&& o) noexcept {
+    if (this != &o) {
+        close();
+        fd = o.fd;
+        o.fd = INVALID;
+    }
+    return *this;
+}
+
+bool Socket::connect(const std::string& host, int port) {
+    close();
+    if (!netInit()) return false;
+    addrinfo hints{}, *res = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0) return false;
+    for (addrinfo* a = res; a; a = a->ai_next) {
+        intptr_t s = (intptr_t)::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (s == INVALID) continue;
+        if (::connect((int)s, a->ai_addr, (socklen_t)a->ai_addrlen) == 0) {
+            fd = s;
+            break;
+        }
+        closeFd(s);
+    }
+    freeaddrinfo(res);
+    if (valid()) setNoDelay(fd);
+    return valid();
+}
+
+bool Socket::listen(int port) {
+    close();
+    if (!netInit()) return false;
+    addrinfo hints{}, *res = nullptr;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    // Dual-stack IPv6 first, then plain IPv4
+    for (int family : { AF_INET6, AF_INET }) {
+        hints.ai_family = family;
+        if (getaddrinfo(nullptr, std::to_string(port).c_str(), &hints, &res) != 0) continue;
+        intptr_t s = (intptr_t)::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        if (s != INVALID) {
+            int one = 1, zero = 0;
+            setsockopt((int)s, SOL_SOCKET, SO_REUSEADDR, (const char*)&one, sizeof(one));
+            if (family == AF_INET6)
+                setsockopt((int)s, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)&zero, sizeof(zero));
+            if (::bind((int)s, res->ai_addr, (socklen_t)res->ai_addrlen) == 0 && ::listen((int)s, 8) == 0)
+                fd = s;
+            else
+                closeFd(s);
+        }
+        freeaddrinfo(res);
+        if (valid()) return true;
+    }
+    return false;
+}
+
+Socket Socket::accept() {
+    Socket c;
+    if (!valid()) return c;
+    intptr_t s = (intptr_t)::accept((int)fd, nullptr, nullptr);
+    if (s != INVALID) {
+        c.fd = s;
+        setNoDelay(s);
+    }
+    return c;
+}
+
+bool Socket::sendAll(const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len > 0) {
+#if defined(MSG_NOSIGNAL)
+        long n = (long)::send((int)fd, p, len, MSG_NOSIGNAL);    // no SIGPIPE on a dead peer
+#else
+        long n = (long)::send((int)fd, p, (int)len, 0);
+#endif
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+bool Socket::recvAll(void* data, size_t len) {
+    char* p = (char*)data;
+    while (len > 0) {
+        long n = (long)::recv((int)fd, p, (int)len, 0);
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+void Socket::shutdown() {
+    if (!valid()) return;
+#if defined(_WIN32)
+    ::shutdown((SOCKET)fd, SD_BOTH);
+#else
+    ::shutdown((int)fd, SHUT_RDWR);
+#endif
+}
+
+void Socket::close() {
+    if (!valid()) return;
+    closeFd(fd);
+    fd = INVALID;
+}
+
+// ========================================================================
+//  Addresses
+// ========================================================================
+bool parseHostPort(const std::string& s, std::string& host, int& port) {
+    size_t colon = s.rfind(':');
+    if (colon == std::string::npos || colon + 1 >= s.size()) return false;
+    char* end = nullptr;
+    long p = std::strtol(s.c_str() + colon + 1, &end, 10);
+    if (*end != '\0' || p <= 0 || p > 65535) return false;
+    host = s.substr(0, colon);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']')   // [::1]:4000
+        host = host.substr(1, host.size() - 2);
+    if (host.empty()) host = "localhost";
+    port = (int)p;
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ---- TCP sockets ----
+// Blocking stream sockets: POSIX sockets, Winsock on Windows (link with
+// -lws2_32). Move-only; the destructor closes.
+class Socket {
+public:
+    Socket() = default;
+    ~Socket() { close(); }
+    Socket(Socket&& o) noexcept : fd(o.fd) { o.fd = INVALID; }
+    Socket& operator=(Socket&& o) noexcept;
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    bool connect(const std::string& host, int port);
+    bool listen(int port);          // any address, IPv4 and IPv6 where available
+    Socket accept();                // invalid on failure
+    bool valid() const { return fd != INVALID; }
+
+    bool sendAll(const void* data, size_t len);
+    bool recvAll(void* data, size_t len);   // false on error or closed peer
+    // Wakes a recvAll() blocked on another thread; the socket stays open
+    // until close()
+    void shutdown();
+    void close();
+
+private:
+    static constexpr intptr_t INVALID = -1;
+    intptr_t fd = INVALID;
+};
+
+// "host:port" -> parts; false if there is no valid port
+bool parseHostPort(const std::string& s, std::string& host, int& port);
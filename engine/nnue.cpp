@@ -0,0 +1,148 @@
+#include "nnue.h"
+#include <cstdio>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+bool nnueActive = false;
+
+// ---- Network parameters ----
+alignas(32) static int16_t ftWeights[NNUE_FEATURES][NNUE_HIDDEN];
+alignas(32) static int16_t ftBias[NNUE_HIDDEN];
+alignas(32) static int8_t  outWeights[2 * NNUE_HIDDEN];
+static int32_t outBias;
+
+// Features are relative to the perspective: own pieces first, and Dark
+// sees the board rotated 180 degrees (the board is point-symmetric).
+static inline int featureIndex(int perspective, int color, int rank, int sq) {
+    int rel  = (color == perspective) ? 0 : 1;
+    int relSq = (perspective == LIGHT) ? sq : (NUM_SQ - 1 - sq);
+    return (rel * 8 + rank - 1) * NUM_SQ + relSq;
+}
+
+// ========================================================================
+//  Loading
+// ========================================================================
+bool nnueLoad(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    uint32_t header[2];
+    std::vector<int16_t> w((size_t)NNUE_FEATURES * NNUE_HIDDEN), b(NNUE_HIDDEN);
+    std::vector<int8_t>  ow(2 * NNUE_HIDDEN);
+    int32_t ob = 0;
+    bool ok = std::fread(header, sizeof(header), 1, f) == 1
+           && header[0] == NNUE_MAGIC && header[1] == (uint32_t)NNUE_HIDDEN
+           && std::fread(w.data(), sizeof(int16_t), w.size(), f) == w.size()
+           && std::fread(b.data(), sizeof(int16_t), b.size(), f) == b.size()
+           && std::fread(ow.data(), sizeof(int8_t), ow.size(), f) == ow.size()
+           && std::fread(&ob, sizeof(ob), 1, f) == 1;
+    std::fclose(f);
+    if (!ok) return false;
+
+    memcpy(ftWeights, w.data(), sizeof(ftWeights));
+    memcpy(ftBias, b.data(), sizeof(ftBias));
+    memcpy(outWeights, ow.data(), sizeof(outWeights));
+    outBias = ob;
+    nnueActive = true;
+    return true;
+}
+
+void nnueUnload() {
+    nnueActive = false;
+}
+
+// ========================================================================
+//  Accumulator updates (plain loops; the compiler vectorises them)
+// ========================================================================
+void nnueRefresh(Accumulator& acc, const int8_t pieceSq[2][NUM_PIECE_TYPES]) {
+    for (int p = 0; p < 2; p++)
+        memcpy(acc.v[p], ftBias, sizeof(ftBias));
+    for (int color = 0; color < 2; color++)
+        for (int rk = 1; rk <= 8; rk++)
+            if (pieceSq[color][rk] >= 0)
+                nnueAddPiece(acc, color, rk, pieceSq[color][rk]);
+}
+
+void nnueAddPiece(Accumulator& acc, int color, int rank, int sq) {
+    for (int p = 0; p < 2; p++) {
+        const int16_t* w = ftWeights[featureIndex(p, color, rank, sq)];
+        for (int i = 0; i < NNUE_HIDDEN; i++) acc.v[p][i] += w[i];
+    }
+}
+
+void nnueRemovePiece(Accumulator& acc, int color, int rank, int sq) {
+    for (int p = 0; p < 2; p++) {
+        const int16_t* w = ftWeights[featureIndex(p, color, rank, sq)];
+        for (int i = 0; i < NNUE_HIDDEN; i++) acc.v[p][i] -= w[i];
+    }
+}
+
+void nnueMovePiece(Accumulator& acc, int color, int rank, int from, int to) {
+    for (int p = 0; p < 2; p++) {
+        const int16_t* wf = ftWeights[featureIndex(p, color, rank, from)];
+        const int16_t* wt = ftWeights[featureIndex(p, color, rank, to)];
+        for (int i = 0; i < NNUE_HIDDEN; i++) acc.v[p][i] += wt[i] - wf[i];
+    }
+}
+
+// ========================================================================
+//  Output layer: clamp(acc, 0, QA) . outWeights
+// ========================================================================
+static int32_t outputDot(const int16_t* a, const int8_t* w) {
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa   = _mm256_set1_epi16(NNUE_QA);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NNUE_HIDDEN; i += 32) {
+        __m256i lo = _mm256_load_si256((const __m256i*)(a + i));
+        __m256i hi = _mm256_load_si256((const __m256i*)(a + i + 16));
+        lo = _mm256_min_epi16(_mm256_max_epi16(lo, zero), qa);
+        hi = _mm256_min_epi16(_mm256_max_epi16(hi, zero), qa);
+        // packus interleaves 128-bit lanes; permute back to feature order
+        __m256i act = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        __m256i wv  = _mm256_load_si256((const __m256i*)(w + i));
+        // u8 x i8 pair sums fit int16: 2 * 127 * 127 < 32768
+        __m256i prod = _mm256_maddubs_epi16(act, wv);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(prod, ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t qa   = vdupq_n_s16(NNUE_QA);
+    int32x4_t sum = vdupq_n_s32(0);
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        int16x8_t act = vminq_s16(vmaxq_s16(vld1q_s16(a + i), zero), qa);
+        int16x8_t wv  = vmovl_s8(vld1_s8(w + i));
+        sum = vmlal_s16(sum, vget_low_s16(act), vget_low_s16(wv));
+        sum = vmlal_s16(sum, vget_high_s16(act), vget_high_s16(wv));
+    }
+    return vaddvq_s32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        int act = std::min(std::max((int)a[i], 0), NNUE_QA);
+        sum += act * w[i];
+    }
+    return sum;
+#endif
+}
+
+int nnueEvaluate(const Accumulator& acc, int stm) {
+    int32_t sum = outBias
+                + outputDot(acc.v[stm],     outWeights)
+                + outputDot(acc.v[1 - stm], outWeights + NNUE_HIDDEN);
+    int score = (int)((int64_t)sum * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+    // Keep network output clear of the mate score range
+    return std::max(-SCORE_MATE + 2 * MAX_PLY, std::min(SCORE_MATE - 2 * MAX_PLY, score));
+}
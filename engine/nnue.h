@@ -0,0 +1,41 @@
+#pragma once
+#include "types.h"
+
+// ---- Optional neural evaluation ----
+// Architecture: (2 x 8 x 63 piece-square features -> NNUE_HIDDEN) x 2
+// perspectives -> 1 output. The first layer is kept as an int16
+// accumulator per perspective, updated incrementally by make/unmake. The
+// output layer clamps it to [0, NNUE_QA], packs it to uint8, and takes a
+// dot product with int8 weights (AVX2 / NEON / scalar).
+//
+// File format (little endian):
+//   uint32 magic 'JNN1', uint32 hidden size (must equal NNUE_HIDDEN)
+//   int16  ftWeights[NNUE_FEATURES][NNUE_HIDDEN]
+//   int16  ftBias[NNUE_HIDDEN]
+//   int8   outWeights[2 * NNUE_HIDDEN]   (side-to-move half first)
+//   int32  outBias
+constexpr int NNUE_FEATURES = 2 * 8 * NUM_SQ;   // [own/enemy][rank-1][sq]
+constexpr int NNUE_HIDDEN   = 128;
+constexpr int NNUE_QA       = 127;              // activation scale
+constexpr int NNUE_QB       = 64;               // output weight scale
+constexpr int NNUE_SCALE    = 400;              // centipawns per unit output
+constexpr uint32_t NNUE_MAGIC = 0x314E4E4A;     // "JNN1"
+
+struct Accumulator {
+    alignas(32) int16_t v[2][NNUE_HIDDEN];      // [perspective][neuron]
+};
+
+// True once a network has been loaded; Board::evaluate uses it from then on
+extern bool nnueActive;
+
+bool nnueLoad(const std::string& path);         // false = keep previous state
+void nnueUnload();
+
+// Accumulator maintenance
+void nnueRefresh(Accumulator& acc, const int8_t pieceSq[2][NUM_PIECE_TYPES]);
+void nnueAddPiece(Accumulator& acc, int color, int rank, int sq);
+void nnueRemovePiece(Accumulator& acc, int color, int rank, int sq);
+void nnueMovePiece(Accumulator& acc, int color, int rank, int from, int to);
+
+// Score in centipawns from `stm`'s point of view
+int  nnueEvaluate(const Accumulator& acc, int stm);
@@ -0,0 +1,86 @@
+#include "output.h"
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::mutex              outMutex;
+static std::condition_variable queued, written;
+static std::vector<std::string> pending;
+static std::thread             writer;
+static bool                    running = false;
+static uint64_t                numQueued = 0, numWritten = 0;
+
+// Takes everything queued at once, writes it with a single flush
+static void writerLoop() {
+    std::vector<std::string> batch;
+    std::unique_lock<std::mutex> lock(outMutex);
+    for (;;) {
+        queued.wait(lock, [] { return !pending.empty() || !running; });
+        if (pending.empty() && !running) break;
+        batch.swap(pending);
+        lock.unlock();
+        for (const std::string& s : batch) std::fwrite(s.data(), 1, s.size(), stdout);
+        fflush(stdout);
+        lock.lock();
+        numWritten += batch.size();
+        batch.clear();
+        written.notify_all();
+    }
+}
+
+void outStart() {
+    std::lock_guard<std::mutex> lock(outMutex);
+    if (running) return;
+    running = true;
+    writer = std::thread(writerLoop);
+}
+
+void outStop() {
+    {
+        std::lock_guard<std::mutex> lock(outMutex);
+        if (!running) return;
+        running = false;
+    }
+    queued.notify_all();
+    writer.join();
+}
+
+void outFlush() {
+    std::unique_lock<std::mutex> lock(outMutex);
+    written.wait(lock, [] { return !running || numWritten == numQueued; });
+    fflush(stdout);
+}
+
+void outLine(const std::string& line) {
+    std::unique_lock<std::mutex> lock(outMutex);
+    if (!running) {
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::fputc('\n', stdout);
+        fflush(stdout);
+        return;
+    }
+    pending.push_back(line + '\n');
+    numQueued++;
+    lock.unlock();
+    queued.notify_one();
+}
+
+void outLine(const char* fmt, ...) {
+    char buf[2048];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = std::vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < (int)sizeof(buf)) {
+        outLine(std::string(buf, n > 0 ? n : 0));
+        return;
+    }
+    std::string s(n, '\0');
+    va_start(ap, fmt);
+    std::vsnprintf(&s[0], n + 1, fmt, ap);
+    va_end(ap);
+    outLine(s);
+}
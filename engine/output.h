@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+
+// ---- Protocol output ----
+// Lines from any thread (the command loop, the search thread) are queued
+// whole and written by one writer thread, so they never interleave and a
+// slow reader on stdout never stalls the search. Without a writer
+// (tools, outStart not called) lines are written directly.
+void outStart();
+void outStop();                     // drains the queue, then ends the writer
+void outFlush();                    // waits until everything queued is written
+
+// One line, printf-style, newline added
+void outLine(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+void outLine(const std::string& line);
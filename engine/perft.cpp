@@ -0,0 +1,127 @@
+#include "perft.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// ========================================================================
+//  Perft hash
+// ========================================================================
+// Direct-mapped, always-replace. As in the TT, `check` holds key ^ count
+// so a slot torn by two writers fails verification instead of returning
+// a wrong count.
+struct PerftSlot {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> count;
+};
+
+class PerftHash {
+public:
+    explicit PerftHash(size_t sizeMB) {
+        size_t n = 1;
+        while (n * 2 * sizeof(PerftSlot) <= sizeMB * 1024 * 1024) n *= 2;
+        slots.reset(new PerftSlot[n]());
+        mask = n - 1;
+    }
+
+    bool probe(uint64_t key, uint64_t& count) const {
+        const PerftSlot& s = slots[key & mask];
+        uint64_t c = s.count.load(std::memory_order_relaxed);
+        if ((s.check.load(std::memory_order_relaxed) ^ c) != key) return false;
+        count = c;
+        return true;
+    }
+    void store(uint64_t key, uint64_t count) {
+        PerftSlot& s = slots[key & mask];
+        s.check.store(key ^ count, std::memory_order_relaxed);
+        s.count.store(count, std::memory_order_relaxed);
+    }
+
+private:
+    std::unique_ptr<PerftSlot[]> slots;
+    size_t mask = 0;
+};
+
+// Subtree counts depend on the remaining depth as well as the position
+static inline uint64_t perftKey(uint64_t hash, int depth) {
+    return hash ^ ((uint64_t)depth * 0x9E3779B97F4A7C15ULL);
+}
+
+// ========================================================================
+//  Recursive count
+// ========================================================================
+static uint64_t perftNode(Board& b, int depth, PerftHash* hash) {
+    if (depth == 0) return 1;
+    if (b.checkGameOver() != 0) return 0;
+    if (depth == 1) return (uint64_t)b.countMoves();
+
+    uint64_t key = perftKey(b.hash, depth);
+    uint64_t nodes;
+    if (hash && hash->probe(key, nodes)) return nodes;
+
+    Move moves[MAX_MOVES];
+    int count = 0;
+    b.generateMoves(moves, count);
+
+    nodes = 0;
+    for (int i = 0; i < count; i++) {
+        b.makeMove(moves[i]);
+        nodes += perftNode(b, depth - 1, hash);
+        b.unmakeMove();
+    }
+    if (hash) hash->store(key, nodes);
+    return nodes;
+}
+
+// ========================================================================
+//  Root split
+// ========================================================================
+uint64_t runPerft(const Board& root, const PerftOptions& opt) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    Move moves[MAX_MOVES];
+    int count = 0;
+    if (opt.depth > 0 && root.checkGameOver() == 0)
+        root.generateMoves(moves, count);
+
+    std::unique_ptr<PerftHash> hash;
+    if (opt.hashMB > 0) hash.reset(new PerftHash(opt.hashMB));
+
+    // Workers pull root moves from a shared index; results stay in root
+    // move order so divide output is the same for any thread count
+    std::vector<uint64_t> sub(count, 0);
+    std::atomic<int> nextMove{0};
+    auto worker = [&]() {
+        Board b = root;
+        int i;
+        while ((i = nextMove.fetch_add(1)) < count) {
+            b.makeMove(moves[i]);
+            sub[i] = perftNode(b, opt.depth - 1, hash.get());
+            b.unmakeMove();
+        }
+    };
+
+    int nThreads = std::max(1, std::min(opt.threads, count));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < nThreads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    uint64_t total = (opt.depth == 0) ? 1 : 0;
+    for (int i = 0; i < count; i++) {
+        total += sub[i];
+        if (opt.divide)
+            std::printf("%s: %llu\n", moveToStr(moves[i]).c_str(), (unsigned long long)sub[i]);
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    std::printf("perft(%d) = %llu  (%lld ms, %lld nps)\n", opt.depth,
+                (unsigned long long)total, (long long)ms,
+                (long long)(total * 1000 / (uint64_t)std::max<int64_t>(ms, 1)));
+    fflush(stdout);
+    return total;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "board.h"
+
+// ---- Perft (move generator regression) ----
+// Root moves are shared out to `threads` workers, each on its own copy of
+// the board. Subtree counts from depth 2 up are cached in a shared hash of
+// `hashMB` (0 = no hash), and depth-1 nodes are bulk-counted from the
+// generator without making the moves. `divide` prints one line per root
+// move before the total.
+struct PerftOptions {
+    int    depth   = 1;
+    int    threads = 1;
+    size_t hashMB  = 0;
+    bool   divide  = false;
+};
+
+uint64_t runPerft(const Board& root, const PerftOptions& opt);
@@ -1,19 +1,27 @@
 #include "search.h"
+#include "tablebase.h"
+#include "output.h"
 #include <cstring>
 #include <cstdio>
 #include <cmath>
 #include <algorithm>
+#include <mutex>
+#include <thread>
 
 // LMR reduction table (precomputed)
 static int lmrTable[64][64]; // [depth][moveIndex]
-static bool lmrInit = false;
+static std::once_flag lmrInit;  // searchers may be created on several threads
+
+// Quiet history points (butterfly + continuation) per ply of LMR
+// reduction: removed for good history, added for bad
+constexpr int LMR_HISTORY_DIV = 8192;
 
 static void initLMR() {
-    if (lmrInit) return;
-    for (int d = 0; d < 64; d++)
-        for (int m = 0; m < 64; m++)
-            lmrTable[d][m] = (d > 0 && m > 0) ? (int)(0.75 + log(d) * log(m) / 2.5) : 0;
-    lmrInit = true;
+    std::call_once(lmrInit, [] {
+        for (int d = 0; d < 64; d++)
+            for (int m = 0; m < 64; m++)
+                lmrTable[d][m] = (d > 0 && m > 0) ? (int)(0.75 + log(d) * log(m) / 2.5) : 0;
+    });
 }
 
 // ========================================================================
@@ -21,16 +29,9 @@ static void initLMR() {
 // ========================================================================
 void Search::init(size_t ttSizeMB) {
     initLMR();
-    size_t bytes = ttSizeMB * 1024ULL * 1024ULL;
-    ttEntries = bytes / sizeof(TTEntry);
-    // Round down to power of 2
-    size_t p = 1;
-    while (p * 2 <= ttEntries) p *= 2;
-    ttEntries = p;
-    ttMask = ttEntries - 1;
-
-    tt = new TTEntry[ttEntries];
-    memset(tt, 0, ttEntries * sizeof(TTEntry));
+    tt = new TranspositionTable();
+    tt->init(ttSizeMB);
+    evalCache.resize(evalCacheMB);
 
     clearHistory();
     stopped = false;
@@ -39,14 +40,66 @@ void Search::init(size_t ttSizeMB) {
 }
 
 void Search::destroy() {
-    delete[] tt;
+    tt->destroy();
+    delete tt;
     tt = nullptr;
 }
 
+void Search::resizeTT(size_t ttSizeMB) {
+    tt->resize(ttSizeMB);
+}
+
+void Search::newGame() {
+    clearEvals();
+    clearHistory();
+}
+
+// Eval caches and TT slots hold scores of the evaluator that stored them
+void Search::clearEvals() {
+    tt->clear();
+    evalCache.clear();
+    for (auto& h : helpers) h->evalCache.clear();
+}
+
+void Search::resizeEvalCache(size_t sizeMB) {
+    evalCacheMB = sizeMB;
+    evalCache.resize(sizeMB);
+    for (auto& h : helpers) {
+        h->evalCacheMB = sizeMB;
+        h->evalCache.resize(sizeMB);
+    }
+}
+
+void EvalCache::resize(size_t sizeMB) {
+    size_t n = std::max<size_t>(1, sizeMB * 1024ULL * 1024ULL / sizeof(uint64_t));
+    // Round down to power of 2
+    size_t p = 1;
+    while (p * 2 <= n) p *= 2;
+    table.assign(p, 0);
+    mask = p - 1;
+}
+
+void Search::setThreads(int n) {
+    if (n < 1) n = 1;
+    helpers.clear();
+    for (int i = 1; i < n; i++) {
+        helpers.emplace_back(new Search());
+        Search& h = *helpers.back();
+        h.threadId = i;
+        h.stopped = false;
+        h.evalCacheMB = evalCacheMB;
+        h.evalCache.resize(evalCacheMB);
+        h.clearHistory();
+    }
+}
+
 void Search::clearHistory() {
     memset(killers, 0, sizeof(killers));
     memset(history, 0, sizeof(history));
+    memset(captureHistory, 0, sizeof(captureHistory));
+    memset(continuation, 0, sizeof(continuation));
     memset(counterMove, 0, sizeof(counterMove));
+    for (auto& h : helpers) h->clearHistory();
 }
 
 // ========================================================================
@@ -58,29 +111,35 @@ int64_t Search::elapsed() const {
 }
 
 void Search::checkTime() {
-    if (isInfinite) return;
-    if (elapsed() >= maxMs) stopped = true;
+    if (pondering) return;
+    if (tm.enabled() && elapsed() >= tm.hardLimit()) stopped = true;
 }
 
 // ========================================================================
 //  TT helpers
 // ========================================================================
-TTEntry* Search::probeTT(uint64_t key) const {
-    TTEntry* e = &tt[key & ttMask];
-    if (e->flag != TT_NONE && e->key == key) return e;
-    return nullptr;
+bool Search::probeTT(uint64_t key, TTEntry& e) const {
+    return tt->probe(key, e);
 }
 
-void Search::storeTT(uint64_t key, int score, Move bestMove, int depth, uint8_t flag) {
-    TTEntry* e = &tt[key & ttMask];
-    // Replace if: empty, same position, or shallower depth
-    if (e->flag == TT_NONE || e->key == key || e->depth <= depth) {
-        e->key      = key;
-        e->score    = (int16_t)score;
-        e->bestMove = bestMove;
-        e->depth    = (int8_t)depth;
-        e->flag     = flag;
+void Search::storeTT(uint64_t key, int score, int eval, Move bestMove, int depth, uint8_t flag) {
+    tt->store(key, score, eval, bestMove, depth, flag);
+}
+
+// ========================================================================
+//  Static evaluation through the eval cache
+// ========================================================================
+int Search::staticEval() {
+    evalLookups++;
+    int score;
+    if (evalCache.probe(board.hash, score)) return score;
+    evalCalls++;
+    {
+        STAT_TIMER(ST_EVAL_CALLS, ST_EVAL_NS);
+        score = board.evaluate();
     }
+    evalCache.store(board.hash, score);
+    return score;
 }
 
 int Search::scoreToTT(int score, int ply) const {
@@ -95,65 +154,14 @@ int Search::scoreFromTT(int score, int ply) const {
     return score;
 }
 
-// ========================================================================
-//  Move ordering
-// ========================================================================
-int Search::scoreMove(Move m, int ply, Move hashMove) const {
-    if (m == hashMove) return 1000000;
-
-    int from = moveFrom(m);
-    int to   = moveTo(m);
-    int target = board.squares[to];
-    int piece  = board.squares[from];
-
-    // Den entry is a winning move - highest priority after hash
-    int color = piece > 0 ? LIGHT : DARK;
-    int oppDen = (color == LIGHT) ? DEN_DARK_SQ : DEN_LIGHT_SQ;
-    if (to == oppDen) return 900000;
-
-    // Captures: MVV-LVA
-    if (target != 0) {
-        int victimVal  = MATERIAL_VAL[abs(target)];
-        int attackerVal = MATERIAL_VAL[abs(piece)];
-        return 500000 + victimVal * 10 - attackerVal;
-    }
-
-    // Killers
-    if (ply < MAX_PLY) {
-        if (m == killers[ply][0]) return 400000;
-        if (m == killers[ply][1]) return 399000;
-    }
-
-    // History heuristic
-    int col = piece > 0 ? LIGHT : DARK;
-    return history[col][from][to];
-}
-
-void Search::orderMoves(Move* moves, int count, int ply, Move hashMove) const {
-    (void)moves; (void)count; (void)ply; (void)hashMove;
-}
-
-void Search::pickBest(Move* moves, int* scores, int count, int cur) const {
-    int bestIdx = cur;
-    int bestScore = scores[cur];
-    for (int i = cur + 1; i < count; i++) {
-        if (scores[i] > bestScore) {
-            bestScore = scores[i];
-            bestIdx = i;
-        }
-    }
-    if (bestIdx != cur) {
-        std::swap(moves[cur], moves[bestIdx]);
-        std::swap(scores[cur], scores[bestIdx]);
-    }
-}
-
 // ========================================================================
 //  Quiescence search
 // ========================================================================
 int Search::quiescence(int alpha, int beta, int ply) {
-    nodes++;
+    countNode();
+    STAT(ST_QS_NODES);
     if (ply > selDepth) selDepth = ply;
+    if (stopped) return 0;
 
     // Check game over
     int gameRes = board.checkGameOver();
@@ -161,34 +169,38 @@ int Search::quiescence(int alpha, int beta, int ply) {
         return gameRes > 0 ? (SCORE_MATE - ply) : -(SCORE_MATE - ply);
     }
 
+    // Tablebase hit: exact result
+    int tbValue;
+    if (tbProbe(board, tbValue)) {
+        tbHits++;
+        return tbScore(tbValue, ply);
+    }
+
+    // Capture sequences can outrun the main search's ply limit; the
+    // copy-make state stack ends at MAX_PLY
+    if (ply >= MAX_PLY - 1) return staticEval();
+
     // Stand pat
-    int standPat = board.evaluate();
+    int standPat = staticEval();
     if (standPat >= beta) return standPat;
     if (standPat > alpha) alpha = standPat;
 
-    // Generate captures only
-    Move moves[MAX_MOVES];
-    int count = 0;
-    board.generateCaptures(moves, count);
-
-    // Score and sort captures
-    int scores[MAX_MOVES];
-    for (int i = 0; i < count; i++)
-        scores[i] = scoreMove(moves[i], ply, MOVE_NONE);
-
-    for (int i = 0; i < count; i++) {
-        pickBest(moves, scores, count, i);
-
+    // Captures only, MVV-LVA and capture history order
+    MovePicker mp(board, &captureHistory);
+    Move m;
+    while ((m = mp.next()) != MOVE_NONE) {
         // Delta pruning
-        int target = board.squares[moveTo(moves[i])];
+        int target = board.squares[moveTo(m)];
         if (target != 0) {
             int gain = MATERIAL_VAL[abs(target)];
             if (standPat + gain + 200 < alpha) continue;
         }
+        // Captures that lose material in the exchange
+        if (board.see(m) < 0) continue;
 
-        board.makeMove(moves[i]);
+        makeMove(m, ply);
         int score = -quiescence(-beta, -alpha, ply + 1);
-        board.unmakeMove();
+        unmakeMove(ply);
 
         if (score > alpha) {
             alpha = score;
@@ -214,36 +226,64 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
     // Repetition
     if (ply > 0 && board.isRepetition()) return SCORE_DRAW;
 
+    // Upcoming repetition: we can force the draw with one move, so the
+    // node is worth at least a draw
+    if (ply > 0 && alpha < SCORE_DRAW && board.hasUpcomingRepetition()) {
+        alpha = SCORE_DRAW;
+        if (alpha >= beta) return alpha;
+    }
+
     // 200 half-move draw
     if (board.halfmove >= 200) return SCORE_DRAW;
 
+    // Tablebase hit: exact result (the root still searches for a move)
+    int tbValue;
+    if (ply > 0 && tbProbe(board, tbValue)) {
+        tbHits++;
+        return tbScore(tbValue, ply);
+    }
+
     // Max ply
-    if (ply >= MAX_PLY - 1) return board.evaluate();
+    if (ply >= MAX_PLY - 1) return staticEval();
 
     // Leaf: quiescence
     if (depth <= 0) return quiescence(alpha, beta, ply);
 
-    nodes++;
+    countNode();
+    STAT(ST_MAIN_NODES);
     if (ply > selDepth) selDepth = ply;
 
-    // Check time every 4096 nodes
-    if ((nodes & 4095) == 0) checkTime();
+    // Check time every 1024 nodes (a few microseconds)
+    if ((nodes.load(std::memory_order_relaxed) & 1023) == 0) checkTime();
+    // Node budget: exact, so fixed-node searches are reproducible
+    if (nodeLimit && nodes.load(std::memory_order_relaxed) >= nodeLimit) stopped = true;
     if (stopped) return 0;
 
     // ---- TT probe ----
+    // A singular search shares the node's key: no cutoffs and no store
+    Move excludedMv = excludedMove[ply];
     Move hashMove = MOVE_NONE;
-    TTEntry* tte = probeTT(board.hash);
-    if (tte) {
-        hashMove = tte->bestMove;
-        if (!isPV && tte->depth >= depth) {
-            int ttScore = scoreFromTT(tte->score, ply);
-            if (tte->flag == TT_EXACT) return ttScore;
-            if (tte->flag == TT_BETA  && ttScore >= beta)  return ttScore;
-            if (tte->flag == TT_ALPHA && ttScore <= alpha) return ttScore;
+    int ttEval = EVAL_NONE;
+    TTEntry tte{};
+    bool ttHit = probeTT(board.hash, tte);
+    STAT(ST_TT_PROBES);
+    if (ttHit) {
+        STAT(ST_TT_HITS);
+        hashMove = tte.bestMove;
+        ttEval = tte.eval;
+        if (!isPV && excludedMv == MOVE_NONE && tte.depth >= depth) {
+            int ttScore = scoreFromTT(tte.score, ply);
+            if (tte.flag == TT_EXACT
+                || (tte.flag == TT_BETA  && ttScore >= beta)
+                || (tte.flag == TT_ALPHA && ttScore <= alpha)) {
+                STAT(ST_TT_CUTOFFS);
+                return ttScore;
+            }
         }
     }
 
-    int staticEval = board.evaluate();
+    // Static eval: from the TT entry when present, else evaluate (cached)
+    int staticEval = (ttEval != EVAL_NONE) ? ttEval : this->staticEval();
     bool inDanger = false;
 
     // Are we in danger? (opponent has piece 1-2 steps from our den)
@@ -262,19 +302,24 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
     // ---- Razoring ----
     if (!isPV && !inDanger && depth <= 2 && staticEval + 300 * depth <= alpha
         && abs(alpha) < SCORE_MATE - MAX_PLY) {
+        STAT(ST_RAZOR_TRIES);
         int qScore = quiescence(alpha, beta, ply);
-        if (qScore <= alpha) return qScore;
+        if (qScore <= alpha) {
+            STAT(ST_RAZOR_CUTS);
+            return qScore;
+        }
     }
 
     // ---- Reverse futility pruning ----
     if (!isPV && !inDanger && depth <= 3
         && staticEval - 120 * depth >= beta
         && abs(beta) < SCORE_MATE - MAX_PLY) {
+        STAT(ST_RFP_CUTS);
         return staticEval - 120 * depth;
     }
 
     // ---- Null move pruning ----
-    if (!isPV && allowNull && depth >= 3
+    if (!isPV && allowNull && depth >= 3 && excludedMv == MOVE_NONE
         && !inDanger
         && staticEval >= beta
         && board.pieceCount[board.sideToMove] >= 2
@@ -282,45 +327,78 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
 
         int R = 3 + depth / 6;
         if (R > depth - 1) R = depth - 1;
+        STAT(ST_NULL_TRIES);
+        contStack[ply + 2] = nullptr;
         board.makeNullMove();
         int nullScore = -alphaBeta(depth - 1 - R, -beta, -beta + 1, ply + 1, false, false);
         board.unmakeNullMove();
 
         if (stopped) return 0;
         if (nullScore >= beta) {
+            STAT(ST_NULL_CUTS);
             if (nullScore >= SCORE_MATE - MAX_PLY) nullScore = beta;
             return nullScore;
         }
     }
 
+    // ---- ProbCut ----
+    // A capture that beats beta by a margin in a reduced search almost
+    // certainly beats it at full depth. Skipped when the TT already says
+    // the node stays below that margin.
+    int probBeta = beta + 200;
+    if (!isPV && depth >= 5 && excludedMv == MOVE_NONE
+        && abs(beta) < SCORE_MATE - MAX_PLY
+        && !(ttHit && tte.depth >= depth - 3 && tte.flag != TT_BETA
+             && scoreFromTT(tte.score, ply) < probBeta)) {
+        MovePicker pc(board, &captureHistory);
+        Move cm;
+        while ((cm = pc.next()) != MOVE_NONE) {
+            if (staticEval + MATERIAL_VAL[abs(board.squares[moveTo(cm)])] < probBeta) continue;
+            contStack[ply + 2] = &continuation[pieceIndex(board.squares[moveFrom(cm)])][moveTo(cm)];
+            makeMove(cm, ply);
+            int score = -quiescence(-probBeta, -probBeta + 1, ply + 1);
+            if (score >= probBeta)
+                score = -alphaBeta(depth - 4, -probBeta, -probBeta + 1, ply + 1, false, true);
+            unmakeMove(ply);
+            if (stopped) return 0;
+            if (score >= probBeta) {
+                storeTT(board.hash, scoreToTT(score, ply), staticEval, cm, depth - 3, TT_BETA);
+                return score;
+            }
+        }
+    }
+
     // ---- Internal iterative deepening ----
     if (isPV && hashMove == MOVE_NONE && depth >= 4) {
         alphaBeta(depth - 2, alpha, beta, ply, true, false);
         if (stopped) return 0;
-        tte = probeTT(board.hash);
-        if (tte) hashMove = tte->bestMove;
+        ttHit = probeTT(board.hash, tte);
+        if (ttHit) hashMove = tte.bestMove;
     }
 
-    // ---- Generate moves ----
-    Move moves[MAX_MOVES];
-    int moveCount = 0;
-    board.generateMoves(moves, moveCount);
-
-    if (moveCount == 0) return -(SCORE_MATE - ply);
-
-    // Score moves
-    int scores[MAX_MOVES];
-    for (int i = 0; i < moveCount; i++)
-        scores[i] = scoreMove(moves[i], ply, hashMove);
+    // ---- Staged move loop ----
+    Move prevMove = (board.ply > 0) ? board.undoStack[board.ply - 1].move : MOVE_NONE;
+    Move counter  = (prevMove != MOVE_NONE) ? counterMove[moveFrom(prevMove)][moveTo(prevMove)] : MOVE_NONE;
+    const PieceToHistory* cont1 = contStack[ply + 1];
+    const PieceToHistory* cont2 = contStack[ply];
+    MovePicker mp(board, hashMove, killers[ply], counter, history[board.sideToMove],
+                  captureHistory, cont1, cont2);
 
     int bestScore = -SCORE_INF;
     Move bestMove = MOVE_NONE;
     uint8_t ttFlag = TT_ALPHA;
     int movesSearched = 0;
+    Move quiets[MAX_MOVES], captures[MAX_MOVES];    // searched without a cutoff
+    int numQuiets = 0, numCaptures = 0;
+
+    Move m;
+    while ((m = mp.next()) != MOVE_NONE) {
+        // MultiPV: moves of the lines already found are skipped at the root
+        if (ply == 0 && numExcluded > 0
+            && std::find(excluded, excluded + numExcluded, m) != excluded + numExcluded)
+            continue;
+        if (m == excludedMv) continue;
 
-    for (int i = 0; i < moveCount; i++) {
-        pickBest(moves, scores, moveCount, i);
-        Move m = moves[i];
         int from = moveFrom(m);
         int to   = moveTo(m);
         bool isCapture = (board.squares[to] != 0);
@@ -332,16 +410,35 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
         if (to == oppDen) {
             pv[ply][ply] = m;
             pvLen[ply] = ply + 1;
-            storeTT(board.hash, scoreToTT(SCORE_MATE - ply, ply), m, depth, TT_EXACT);
+            storeTT(board.hash, scoreToTT(SCORE_MATE - ply, ply), staticEval, m, depth, TT_EXACT);
             return SCORE_MATE - ply;
         }
 
         // ---- Extensions ----
         int extension = 0;
-        // Extend when opponent piece is very close to our den
-        if (inDanger) extension = 1;
-        // Extend captures of high-value pieces
-        if (isCapture && abs(board.squares[to]) >= TIGER) extension = std::max(extension, 1);
+        // Extensions stop at twice the root depth, otherwise shuffling
+        // lines near a den can extend every ply all the way to MAX_PLY
+        if (ply < 2 * rootDepth) {
+            // Extend when opponent piece is very close to our den
+            if (inDanger) extension = 1;
+            // Extend captures of high-value pieces
+            if (isCapture && abs(board.squares[to]) >= TIGER) extension = std::max(extension, 1);
+
+            // Singular extension: extend the TT move when every other move
+            // fails low against a margin below its score. If the others
+            // beat beta too, several moves cut: prune the node (multi-cut).
+            if (depth >= 8 && m == hashMove && ply > 0 && excludedMv == MOVE_NONE
+                && ttHit && tte.depth >= depth - 3 && tte.flag != TT_ALPHA
+                && abs(scoreFromTT(tte.score, ply)) < SCORE_MATE - MAX_PLY) {
+                int singularBeta = scoreFromTT(tte.score, ply) - 2 * depth;
+                excludedMove[ply] = m;
+                int s = alphaBeta((depth - 1) / 2, singularBeta - 1, singularBeta, ply, false, false);
+                excludedMove[ply] = MOVE_NONE;
+                if (stopped) return 0;
+                if (s < singularBeta) extension = 1;
+                else if (singularBeta >= beta) return singularBeta;
+            }
+        }
 
         int newDepth = depth - 1 + extension;
 
@@ -351,12 +448,21 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
             && abs(alpha) < SCORE_MATE - MAX_PLY) {
             int futilityMargin = depth * 150;
             if (staticEval + futilityMargin <= alpha) {
+                STAT(ST_FUTILITY_PRUNES);
                 movesSearched++;
                 continue;
             }
         }
 
-        board.makeMove(m);
+        int pc = pieceIndex(piece);
+        int hist = 0;
+        if (!isCapture) {
+            hist = history[board.sideToMove][from][to];
+            if (cont1) hist += (*cont1)[pc][to];
+            if (cont2) hist += (*cont2)[pc][to];
+        }
+        contStack[ply + 2] = &continuation[pc][to];
+        makeMove(m, ply);
 
         int score;
 
@@ -368,8 +474,11 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
             int reduction = 0;
             if (depth >= 3 && movesSearched >= 2 && !isCapture && !inDanger) {
                 reduction = lmrTable[std::min(depth, 63)][std::min(movesSearched, 63)];
-                // Reduce less in PV nodes
-                if (isPV) reduction = std::max(0, reduction - 1);
+                // Reduce less in PV nodes, more in zero-window ones
+                reduction += isPV ? -1 : 1;
+                // Less for killers and the counter move; by history either way
+                if (m == killers[ply][0] || m == killers[ply][1] || m == counter) reduction--;
+                reduction -= hist / LMR_HISTORY_DIV;
                 // Don't reduce into negative
                 reduction = std::min(reduction, newDepth - 1);
                 if (reduction < 0) reduction = 0;
@@ -379,7 +488,9 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
             score = -alphaBeta(newDepth - reduction, -alpha - 1, -alpha, ply + 1, false, true);
 
             // Step 2: If reduced and failed high, re-search without reduction (still zero window)
+            if (reduction > 0) STAT(ST_LMR_SEARCHES);
             if (score > alpha && reduction > 0) {
+                STAT(ST_LMR_RESEARCHES);
                 score = -alphaBeta(newDepth, -alpha - 1, -alpha, ply + 1, false, true);
             }
 
@@ -389,7 +500,7 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
             }
         }
 
-        board.unmakeMove();
+        unmakeMove(ply);
 
         if (stopped) return 0;
 
@@ -410,132 +521,357 @@ int Search::alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool a
                 pvLen[ply] = pvLen[ply + 1];
 
                 if (score >= beta) {
+                    STAT(ST_FAIL_HIGHS);
+                    if (movesSearched == 1) STAT(ST_FAIL_HIGH_FIRST);
                     ttFlag = TT_BETA;
-
-                    // Update killers and history for quiet moves
-                    if (!isCapture && ply < MAX_PLY) {
-                        if (m != killers[ply][0]) {
-                            killers[ply][1] = killers[ply][0];
-                            killers[ply][0] = m;
-                        }
-                        // History bonus
-                        int bonus = depth * depth;
-                        history[board.sideToMove][from][to] += bonus;
-                        // Age history periodically
-                        if (history[board.sideToMove][from][to] > 100000) {
-                            for (auto& row : history)
-                                for (auto& col : row)
-                                    for (auto& v : col)
-                                        v /= 2;
-                        }
-                    }
+                    updateHistories(ply, depth, m, quiets, numQuiets, captures, numCaptures);
                     break;
                 }
             }
         }
+
+        if (isCapture) captures[numCaptures++] = m;
+        else           quiets[numQuiets++] = m;
     }
 
-    // Store TT
-    storeTT(board.hash, scoreToTT(bestScore, ply), bestMove, depth, ttFlag);
+    // No legal moves: loss. Singular search: the TT move was the only one.
+    if (movesSearched == 0) return excludedMv != MOVE_NONE ? alpha : -(SCORE_MATE - ply);
+
+    // Store TT (not for a root with excluded moves or a singular search:
+    // it is not the real score)
+    if ((ply > 0 || numExcluded == 0) && excludedMv == MOVE_NONE)
+        storeTT(board.hash, scoreToTT(bestScore, ply), staticEval, bestMove, depth, ttFlag);
 
     return bestScore;
 }
 
+// ========================================================================
+//  History updates
+// ========================================================================
+// On a beta cutoff by `best`: a quiet move becomes a killer and the counter
+// move and gains butterfly and continuation history, which the quiets
+// searched before it lose; a capture gains capture history. Captures that
+// did not cut lose it either way.
+void Search::updateHistories(int ply, int depth, Move best, const Move* quiets, int numQuiets,
+                             const Move* captures, int numCaptures) {
+    int bonus = std::min(32 * depth * depth, 2048);
+    int stm = board.sideToMove;
+    PieceToHistory* cont1 = contStack[ply + 1];
+    PieceToHistory* cont2 = contStack[ply];
+
+    auto quietStats = [&](Move m, int b) {
+        int from = moveFrom(m), to = moveTo(m), pc = pieceIndex(board.squares[from]);
+        updateHistory(history[stm][from][to], b);
+        if (cont1) updateHistory((*cont1)[pc][to], b);
+        if (cont2) updateHistory((*cont2)[pc][to], b);
+    };
+    auto captureStats = [&](Move m, int b) {
+        int from = moveFrom(m), to = moveTo(m);
+        updateHistory(captureHistory[pieceIndex(board.squares[from])][to][abs(board.squares[to])], b);
+    };
+
+    if (board.squares[moveTo(best)] == 0) {
+        if (best != killers[ply][0]) {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = best;
+        }
+        Move prevMove = (board.ply > 0) ? board.undoStack[board.ply - 1].move : MOVE_NONE;
+        if (prevMove != MOVE_NONE)
+            counterMove[moveFrom(prevMove)][moveTo(prevMove)] = best;
+        quietStats(best, bonus);
+        for (int i = 0; i < numQuiets; i++) quietStats(quiets[i], -bonus);
+    } else {
+        captureStats(best, bonus);
+    }
+    for (int i = 0; i < numCaptures; i++) captureStats(captures[i], -bonus);
+}
+
 // ========================================================================
 //  Iterative deepening + aspiration windows
 // ========================================================================
-Move Search::think(int maxDepth, int64_t moveTimeMs, bool infinite) {
+int Search::aspiration(int depth, int prevScore) {
+    int alpha, beta;
+
+    // Aspiration window
+    if (depth >= 5) {
+        int window = 40;
+        alpha = prevScore - window;
+        beta  = prevScore + window;
+    } else {
+        alpha = -SCORE_INF;
+        beta  =  SCORE_INF;
+    }
+
+    int score = alphaBeta(depth, alpha, beta, 0, true, true);
+    rootFailLow = !stopped && score <= alpha;
+
+    // Aspiration window re-search with wider windows
+    if (!stopped && (score <= alpha || score >= beta)) {
+        // Widen by 3x
+        int window2 = 150;
+        alpha = std::max(-SCORE_INF, prevScore - window2);
+        beta  = std::min( SCORE_INF, prevScore + window2);
+        score = alphaBeta(depth, alpha, beta, 0, true, true);
+
+        // If still fails, full window
+        if (!stopped && (score <= alpha || score >= beta)) {
+            score = alphaBeta(depth, -SCORE_INF, SCORE_INF, 0, true, true);
+        }
+    }
+    return score;
+}
+
+int64_t Search::totalNodes() const {
+    int64_t n = nodes.load(std::memory_order_relaxed);
+    for (const auto& h : helpers) n += h->nodes.load(std::memory_order_relaxed);
+    return n;
+}
+
+// Helper threads skip depths in a staggered pattern so that the threads
+// spread over several iterations instead of all searching the same one.
+static const int SKIP_SIZE[]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static const int SKIP_PHASE[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+void Search::helperSearch(int maxDepth) {
+    threadStats = &stats;
+    memset(killers, 0, sizeof(killers));
+    std::fill(excludedMove, excludedMove + MAX_PLY, MOVE_NONE);
+    contStack[0] = contStack[1] = nullptr;
+    int slot = (threadId - 1) % 20;
+    int prevScore = 0;
+
+    for (int depth = 1; depth <= maxDepth && !stopped; depth++) {
+        if (((depth + SKIP_PHASE[slot]) / SKIP_SIZE[slot]) % 2) continue;
+        selDepth = 0;
+        rootDepth = depth;
+        int score = aspiration(depth, prevScore);
+        if (stopped) break;
+        prevScore = score;
+    }
+}
+
+void Search::printInfo(int depth, int multipv, const RootLine& line, int64_t ms) {
+    int64_t allNodes = totalNodes();
+    int64_t nps = (ms > 0) ? (allNodes * 1000 / ms) : allNodes;
+    int score = line.score;
+
+    // Built whole: the line is queued as one unit
+    char buf[256];
+    std::string out;
+    std::snprintf(buf, sizeof(buf), "info depth %d seldepth %d ", depth, line.selDepth);
+    out += buf;
+    if (multipv > 0) {
+        std::snprintf(buf, sizeof(buf), "multipv %d ", multipv);
+        out += buf;
+    }
+    if (abs(score) >= SCORE_MATE - MAX_PLY) {
+        int matePly = SCORE_MATE - abs(score);
+        int mateIn = (matePly + 1) / 2;
+        std::snprintf(buf, sizeof(buf), "score mate %s%d", score > 0 ? "" : "-", mateIn);
+    } else {
+        std::snprintf(buf, sizeof(buf), "score cp %d", score);
+    }
+    out += buf;
+
+    std::snprintf(buf, sizeof(buf), " nodes %lld nps %lld hashfull %d time %lld",
+                  (long long)allNodes, (long long)nps, tt->hashfull(), (long long)ms);
+    out += buf;
+    if (tbMaxPieces > 0) {
+        int64_t hits = tbHits;
+        for (auto& h : helpers) hits += h->tbHits;
+        std::snprintf(buf, sizeof(buf), " tbhits %lld", (long long)hits);
+        out += buf;
+    }
+    out += " pv";
+    for (int i = 0; i < line.len; i++) out += " " + moveToStr(line.pv[i]);
+    outLine(out);
+}
+
+Move Search::think(const SearchLimits& limits) {
     startTime = std::chrono::steady_clock::now();
     stopped = false;
-    isInfinite = infinite;
     nodes = 0;
     selDepth = 0;
+    evalCalls = evalLookups = 0;
+    tbHits = 0;
+    rootFailLow = false;
+    searchesStarted++;          // from here on a stop() belongs to this search
+    stats.clear();
+    threadStats = &stats;
 
-    if (maxDepth <= 0) maxDepth = 100;
-    if (moveTimeMs <= 0 && !infinite) moveTimeMs = 5000;
-
-    allocatedMs = moveTimeMs;
-    maxMs = infinite ? 999999999LL : (int64_t)(moveTimeMs * 1.5);
-    timeManaged = !infinite;
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : 100;
+    tm.init(limits, board.sideToMove);
+    nodeLimit = limits.nodes;
 
     // Clear killers (keep history across searches for strength)
     memset(killers, 0, sizeof(killers));
+    std::fill(excludedMove, excludedMove + MAX_PLY, MOVE_NONE);
+    contStack[0] = contStack[1] = nullptr;
 
     rootBest = MOVE_NONE;
+    rootPonder = MOVE_NONE;
     rootScore = 0;
+    mainLine.score = 0;
+    mainLine.len = 0;
+    mainLine.selDepth = 0;
+    tt->newSearch();
+
+    // go searchmoves: the other root moves stay excluded in every line (and
+    // in the helpers); when none of the listed moves is legal, search all
+    Move rootMoves[MAX_MOVES];
+    int numRootMoves = 0;
+    board.generateMoves(rootMoves, numRootMoves);
+    numRootSkipped = 0;
+    if (!limits.searchMoves.empty()) {
+        int n = 0;
+        for (int i = 0; i < numRootMoves; i++) {
+            const auto& sm = limits.searchMoves;
+            if (std::find(sm.begin(), sm.end(), rootMoves[i]) != sm.end()) rootMoves[n++] = rootMoves[i];
+            else excluded[numRootSkipped++] = rootMoves[i];
+        }
+        if (n > 0) numRootMoves = n;
+        else       numRootSkipped = 0;
+    }
+    numExcluded = numRootSkipped;
+
+    // Start Lazy SMP helpers on copies of the root position.
+    // Only the main thread checks the clock; it stops the helpers when done.
+    std::vector<std::thread> workers;
+    for (auto& h : helpers) {
+        h->tt        = tt;
+        h->board     = board;
+        h->stopped   = false;
+        h->nodes     = 0;
+        h->evalCalls = h->evalLookups = 0;
+        h->tbHits    = 0;
+        h->stats.clear();
+        std::copy(excluded, excluded + numRootSkipped, h->excluded);
+        h->numRootSkipped = h->numExcluded = numRootSkipped;
+        workers.emplace_back(&Search::helperSearch, h.get(), maxDepth);
+    }
 
-    int prevScore = 0;
+    // MultiPV: one root search per line, each excluding the moves of the
+    // lines above it and keeping its own aspiration window. Later lines
+    // are cheap because the TT is already warm from the first.
+    int numLines = std::max(1, std::min(multiPV, numRootMoves));
+    std::vector<RootLine> lines(numLines), next(numLines);
+    for (auto& l : lines) { l.score = 0; l.len = 0; l.selDepth = 0; }
+    firstFailLow = false;
 
     for (int depth = 1; depth <= maxDepth; depth++) {
-        selDepth = 0;
-        int alpha, beta;
-
-        // Aspiration window
-        if (depth >= 5) {
-            int window = 40;
-            alpha = prevScore - window;
-            beta  = prevScore + window;
-        } else {
-            alpha = -SCORE_INF;
-            beta  =  SCORE_INF;
+        rootDepth = depth;
+        numExcluded = numRootSkipped;
+        int done = 0;
+        for (int k = 0; k < numLines; k++) {
+            selDepth = 0;
+            int score = aspiration(depth, lines[k].score);
+            if (stopped) break;
+            if (k == 0) firstFailLow = rootFailLow;
+            next[k].score = score;
+            next[k].len = pvLen[0];
+            next[k].selDepth = selDepth;
+            memcpy(next[k].pv, pv[0], sizeof(Move) * pvLen[0]);
+            if (pvLen[0] > 0) excluded[numExcluded++] = pv[0][0];
+            done++;
         }
 
-        int score = alphaBeta(depth, alpha, beta, 0, true, true);
+        if (stopped && depth > 1) break;
 
-        // Aspiration window re-search with wider windows
-        if (!stopped && (score <= alpha || score >= beta)) {
-            // Widen by 3x
-            int window2 = 150;
-            alpha = std::max(-SCORE_INF, prevScore - window2);
-            beta  = std::min( SCORE_INF, prevScore + window2);
-            score = alphaBeta(depth, alpha, beta, 0, true, true);
-
-            // If still fails, full window
-            if (!stopped && (score <= alpha || score >= beta)) {
-                score = alphaBeta(depth, -SCORE_INF, SCORE_INF, 0, true, true);
+        // Stopped during depth 1: keep what was found, at worst a partial PV
+        if (done < numLines) {
+            if (done == 0) {
+                next[0].score = 0;
+                next[0].len = pvLen[0];
+                next[0].selDepth = selDepth;
+                memcpy(next[0].pv, pv[0], sizeof(Move) * pvLen[0]);
+                done = 1;
             }
+            numLines = done;
+            next.resize(done);
         }
 
-        if (stopped && depth > 1) break;
+        // Lines can come back out of order when a later one finds more
+        std::stable_sort(next.begin(), next.end(),
+                         [](const RootLine& a, const RootLine& b) { return a.score > b.score; });
+        lines = next;
+        numExcluded = numRootSkipped;
 
         // Update root best
-        if (pvLen[0] > 0) {
-            rootBest = pv[0][0];
+        int score = lines[0].score;
+        if (lines[0].len > 0) {
+            rootBest = lines[0].pv[0];
+            rootPonder = lines[0].len > 1 ? lines[0].pv[1] : MOVE_NONE;
             rootScore = score;
+            mainLine = lines[0];
         }
-        prevScore = score;
 
-        // Print info
         int64_t ms = elapsed();
-        int64_t nps = (ms > 0) ? (nodes * 1000 / ms) : nodes;
-
-        std::printf("info depth %d seldepth %d score ", depth, selDepth);
-        if (abs(score) >= SCORE_MATE - MAX_PLY) {
-            int matePly = SCORE_MATE - abs(score);
-            int mateIn = (matePly + 1) / 2;
-            if (score > 0) std::printf("mate %d", mateIn);
-            else std::printf("mate -%d", mateIn);
-        } else {
-            std::printf("cp %d", score);
+        for (int k = 0; k < numLines; k++) {
+            if (onInfo) onInfo(depth, numLines > 1 ? k + 1 : 0, lines[k], ms);
+            else if (!silent) printInfo(depth, numLines > 1 ? k + 1 : 0, lines[k], ms);
         }
 
-        std::printf(" nodes %lld nps %lld time %lld pv",
-                     (long long)nodes, (long long)nps, (long long)ms);
-        for (int i = 0; i < pvLen[0]; i++)
-            std::printf(" %s", moveToStr(pv[0][i]).c_str());
-        std::printf("\n");
-        fflush(stdout);
-
-        // Time: don't start new iteration if we've used >40% of time
-        if (timeManaged && ms >= allocatedMs * 2 / 5) break;
+        // Time: soft limit, scaled by how settled the search is.
+        // While pondering the clock is not ours yet.
+        if (tm.iterationDone(depth, ms, rootBest, score, firstFailLow) && !pondering) break;
 
         // Proven mate at this depth - stop
         if (abs(score) >= SCORE_MATE - depth) break;
     }
+    numExcluded = numRootSkipped = 0;
+
+    // A ponder or infinite search must not answer before ponderhit / stop
+    {
+        std::unique_lock<std::mutex> lock(stopMutex);
+        stopCond.wait(lock, [&] { return !(pondering || limits.infinite) || stopped; });
+    }
+
+    for (auto& h : helpers) h->stopped = true;
+    for (auto& w : workers) w.join();
+
+    // No reply in the PV (e.g. cut short by the TT): take the hash move
+    if (rootPonder == MOVE_NONE && rootBest != MOVE_NONE) {
+        board.makeMove(rootBest);
+        TTEntry e;
+        if (board.checkGameOver() == 0 && probeTT(board.hash, e) && board.isLegal(e.bestMove))
+            rootPonder = e.bestMove;
+        board.unmakeMove();
+    }
+
+    // Evaluation statistics, summed over threads
+    if (!silent) {
+        int64_t allNodes = totalNodes(), calls = evalCalls, lookups = evalLookups;
+        for (auto& h : helpers) { calls += h->evalCalls; lookups += h->evalLookups; }
+        outLine("info string evals %lld (%.3f per node) cache hits %lld of %lld",
+                    (long long)calls, allNodes ? (double)calls / allNodes : 0.0,
+                    (long long)(lookups - calls), (long long)lookups);
+        if (SEARCH_STATS_ENABLED) outLine(searchStats().format(true));
+    }
+    threadStats = nullptr;
 
     return rootBest;
 }
 
+SearchStats Search::searchStats() const {
+    SearchStats sum = stats;
+    for (auto& h : helpers) sum.add(h->stats);
+    return sum;
+}
+
+// Called from the command thread: every searcher sees its flag at the next
+// node, and a finished ponder / infinite search is woken at once
 void Search::stop() {
+    std::lock_guard<std::mutex> lock(stopMutex);
+    pondering = false;
     stopped = true;
+    for (auto& h : helpers) h->stopped = true;
+    stopCond.notify_all();
+}
+
+// The search keeps running; from now on the time manager's limits apply,
+// measured from the start of the ponder search
+void Search::ponderhit() {
+    std::lock_guard<std::mutex> lock(stopMutex);
+    pondering = false;
+    stopCond.notify_all();
 }
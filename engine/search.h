@@ -1,19 +1,46 @@
 #pragma once
 #include "board.h"
+#include "tt.h"
+#include "movepick.h"
+#include "timeman.h"
+#include "searchstats.h"
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <memory>
+#include <vector>
 
-// ---- Transposition Table ----
-constexpr uint8_t TT_NONE  = 0;
-constexpr uint8_t TT_EXACT = 1;
-constexpr uint8_t TT_ALPHA = 2; // upper bound (fail-low)
-constexpr uint8_t TT_BETA  = 3; // lower bound (fail-high)
-
-struct TTEntry {
-    uint64_t key;
-    int16_t  score;
-    Move     bestMove;
-    int8_t   depth;
-    uint8_t  flag;
+// ---- Evaluation cache ----
+// Small direct-mapped hash -> static eval table, one per search thread.
+// Each entry packs the upper 48 key bits with the 16-bit score.
+class EvalCache {
+public:
+    void resize(size_t sizeMB);
+    void clear() { std::fill(table.begin(), table.end(), 0); }
+
+    bool probe(uint64_t key, int& score) const {
+        uint64_t e = table[key & mask];
+        if ((e ^ key) >> 16) return false;
+        score = (int16_t)(uint16_t)e;
+        return true;
+    }
+    void store(uint64_t key, int score) {
+        table[key & mask] = (key & ~0xFFFFULL) | (uint16_t)(int16_t)score;
+    }
+
+private:
+    std::vector<uint64_t> table = std::vector<uint64_t>(1);
+    size_t mask = 0;
+};
+
+// One root line: score and PV from the last completed iteration
+struct RootLine {
+    int  score;
+    int  len;
+    int  selDepth;
+    Move pv[MAX_PLY];
 };
 
 class Search {
@@ -22,34 +49,89 @@ public:
 
     void init(size_t ttSizeMB = 128);
     void destroy();
+    void resizeTT(size_t ttSizeMB);
+    void newGame();                 // clears TT and history, keeps allocations
+    void clearEvals();              // evaluator changed: drops cached evals and the TT
+    void setThreads(int n);         // total search threads (Lazy SMP)
+    void resizeEvalCache(size_t sizeMB); // per thread
+    size_t hashMB() const { return tt->sizeInMB(); }
+    TranspositionTable& hashTable() { return *tt; }     // savehash / loadhash
+    int  threadCount() const { return 1 + (int)helpers.size(); }
 
-    // Returns best move. Output info lines to stdout.
-    Move think(int maxDepth, int64_t moveTimeMs, bool infinite);
+    // Returns best move. Output info lines to stdout unless `silent`.
+    Move think(const SearchLimits& limits);
     void stop();
+    // go ponder: set before think() starts so an early ponderhit is not lost
+    void startPonder() { pondering = true; }
+    void ponderhit();               // ponder search -> normal timed search
+    // Bumped once think() has reset its flags: a caller running think() on
+    // another thread waits for it so that an immediate stop is not lost
+    int64_t searchCount() const { return searchesStarted; }
+    Move ponderMove() const { return rootPonder; }  // expected reply, may be MOVE_NONE
+    const RootLine& bestLine() const { return mainLine; } // score and PV of the best line
     void clearHistory();
+    int64_t totalNodes() const;     // this thread plus helpers, last search
+    SearchStats searchStats() const; // counters of the last search (SEARCH_STATS builds)
+
+    bool silent = false;
+    int  multiPV = 1;               // number of root lines to report
+    // Set: called for every root line after each iteration (on the search
+    // thread) instead of printing info lines; multipv is 0 for a single line
+    std::function<void(int depth, int multipv, const RootLine& line, int64_t ms)> onInfo;
 
 private:
-    // Transposition table
-    TTEntry* tt;
-    size_t   ttMask;
-    size_t   ttEntries;
+    // Transposition table (owned by the main searcher, shared with helpers)
+    TranspositionTable* tt;
 
     // Search state
-    bool     stopped;
-    int64_t  nodes;
+    std::atomic<bool>    stopped;
+    std::atomic<int64_t> nodes;   // written only by the owning thread
     int      selDepth;
+    int      rootDepth;
+
+    // Lazy SMP: helpers share this searcher's TT, each with its own
+    // board, killers, history and PV. threadId 0 = main thread.
+    std::vector<std::unique_ptr<Search>> helpers;
+    int      threadId = 0;
+
+    // Static evaluation, cached per thread
+    EvalCache evalCache;
+    size_t   evalCacheMB = 4;
+    int64_t  evalCalls;             // board.evaluate() calls
+    int64_t  evalLookups;           // staticEval() requests
+    int64_t  tbHits;                // tablebase probes that found a table
+    SearchStats stats;              // empty unless built with SEARCH_STATS
 
-    // Time management
+    // Time management (main thread only)
     std::chrono::steady_clock::time_point startTime;
-    int64_t  allocatedMs;
-    int64_t  maxMs;
-    bool     timeManaged;
-    bool     isInfinite;
+    TimeManager tm;
+    bool     rootFailLow;           // last aspiration search failed low
+    bool     firstFailLow;          // ... for the first MultiPV line
+    std::atomic<bool> pondering{false};
+    std::mutex        stopMutex;    // stop / ponderhit wake the waiting think()
+    std::condition_variable stopCond;
+    std::atomic<int64_t> searchesStarted{0};
+    int64_t  nodeLimit = 0;         // SearchLimits::nodes
 
     // Move ordering
     Move     killers[MAX_PLY][2];
-    int      history[2][NUM_SQ][NUM_SQ];
-    int      counterMove[NUM_SQ][NUM_SQ]; // indexed by prev from/to
+    ButterflyHistory history[2];        // [side to move][from][to]
+    CaptureHistory   captureHistory;
+    PieceToHistory   continuation[16][NUM_SQ];  // [prev piece][prev to] -> [piece][to]
+    PieceToHistory*  contStack[MAX_PLY + 2];    // [ply + 2]: table of the move made at ply
+    Move     counterMove[NUM_SQ][NUM_SQ]; // indexed by prev from/to
+    Move     excludedMove[MAX_PLY];   // singular search: TT move skipped at this ply
+
+    // Moves in the tree: copy-make over a per-ply state stack when built
+    // with -DCOPY_MAKE, otherwise make / unmake with the board's undo stack
+#ifdef COPY_MAKE
+    BoardState stateStack[MAX_PLY];
+    void makeMove(Move m, int ply) { board.makeMove(m, stateStack[ply]); }
+    void unmakeMove(int ply)       { board.unmakeMove(stateStack[ply]); }
+#else
+    void makeMove(Move m, int /*ply*/) { board.makeMove(m); }
+    void unmakeMove(int /*ply*/)       { board.unmakeMove(); }
+#endif
 
     // Principal variation
     Move     pv[MAX_PLY][MAX_PLY];
@@ -57,20 +139,28 @@ private:
 
     // Root best
     Move     rootBest;
+    Move     rootPonder;
+    Move     excluded[MAX_MOVES];   // root moves skipped (MultiPV)
+    int      numExcluded = 0;
+    int      numRootSkipped = 0;    // excluded[] prefix outside searchmoves, every line
     int      rootScore;
+    RootLine mainLine;              // lines[0] of the last completed iteration
 
     // Internal methods
     int  alphaBeta(int depth, int alpha, int beta, int ply, bool isPV, bool allowNull);
     int  quiescence(int alpha, int beta, int ply);
+    int  aspiration(int depth, int prevScore);
+    int  staticEval();
+    void updateHistories(int ply, int depth, Move best, const Move* quiets, int numQuiets,
+                         const Move* captures, int numCaptures);
+    void helperSearch(int maxDepth);
+    void printInfo(int depth, int multipv, const RootLine& line, int64_t ms);
+    void countNode() { nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
     void checkTime();
     int64_t elapsed() const;
 
-    void orderMoves(Move* moves, int count, int ply, Move hashMove) const;
-    int  scoreMove(Move m, int ply, Move hashMove) const;
-    void pickBest(Move* moves, int* scores, int count, int cur) const;
-
-    TTEntry* probeTT(uint64_t key) const;
-    void     storeTT(uint64_t key, int score, Move bestMove, int depth, uint8_t flag);
+    bool     probeTT(uint64_t key, TTEntry& e) const;
+    void     storeTT(uint64_t key, int score, int eval, Move bestMove, int depth, uint8_t flag);
     int      scoreToTT(int score, int ply) const;
     int      scoreFromTT(int score, int ply) const;
 };
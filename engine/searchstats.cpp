@@ -0,0 +1,38 @@
+#include "searchstats.h"
+#include <cstdio>
+
+thread_local SearchStats* threadStats = nullptr;
+
+static double pct(int64_t part, int64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+std::string SearchStats::format(bool info) const {
+    const char* pre = info ? "info string stats " : "";
+    int64_t nodes = v[ST_MAIN_NODES] + v[ST_QS_NODES];
+    char buf[1024];
+    std::snprintf(buf, sizeof(buf),
+        "%snodes %lld main %lld qsearch %lld (%.1f%%)\n"
+        "%stt probes %lld hits %lld (%.1f%%) cutoffs %lld (%.1f%%)\n"
+        "%snull tries %lld cuts %lld (%.1f%%)\n"
+        "%slmr reduced %lld re-searched %lld (%.1f%%)\n"
+        "%srazor tries %lld cuts %lld (%.1f%%) rfp cuts %lld futility prunes %lld\n"
+        "%sfail highs %lld on first move %lld (%.1f%%)\n"
+        "%sevaluate %lld calls %.1f ms (%.0f ns/call) movegen %lld calls %.1f ms (%.0f ns/call)",
+        pre, (long long)nodes, (long long)v[ST_MAIN_NODES], (long long)v[ST_QS_NODES],
+        pct(v[ST_QS_NODES], nodes),
+        pre, (long long)v[ST_TT_PROBES], (long long)v[ST_TT_HITS], pct(v[ST_TT_HITS], v[ST_TT_PROBES]),
+        (long long)v[ST_TT_CUTOFFS], pct(v[ST_TT_CUTOFFS], v[ST_TT_PROBES]),
+        pre, (long long)v[ST_NULL_TRIES], (long long)v[ST_NULL_CUTS], pct(v[ST_NULL_CUTS], v[ST_NULL_TRIES]),
+        pre, (long long)v[ST_LMR_SEARCHES], (long long)v[ST_LMR_RESEARCHES],
+        pct(v[ST_LMR_RESEARCHES], v[ST_LMR_SEARCHES]),
+        pre, (long long)v[ST_RAZOR_TRIES], (long long)v[ST_RAZOR_CUTS], pct(v[ST_RAZOR_CUTS], v[ST_RAZOR_TRIES]),
+        (long long)v[ST_RFP_CUTS], (long long)v[ST_FUTILITY_PRUNES],
+        pre, (long long)v[ST_FAIL_HIGHS], (long long)v[ST_FAIL_HIGH_FIRST],
+        pct(v[ST_FAIL_HIGH_FIRST], v[ST_FAIL_HIGHS]),
+        pre, (long long)v[ST_EVAL_CALLS], v[ST_EVAL_NS] / 1e6,
+        v[ST_EVAL_CALLS] ? (double)v[ST_EVAL_NS] / v[ST_EVAL_CALLS] : 0.0,
+        (long long)v[ST_GEN_CALLS], v[ST_GEN_NS] / 1e6,
+        v[ST_GEN_CALLS] ? (double)v[ST_GEN_NS] / v[ST_GEN_CALLS] : 0.0);
+    return buf;
+}
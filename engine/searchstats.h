@@ -0,0 +1,59 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// ---- Search statistics ----
+// Per-thread counters for tuning pruning from data. Compiled in only with
+// -DSEARCH_STATS (the jungle-stats binary, `make stats`); in the release
+// build STAT() and STAT_TIMER() expand to nothing.
+enum Stat {
+    ST_MAIN_NODES, ST_QS_NODES,
+    ST_TT_PROBES, ST_TT_HITS, ST_TT_CUTOFFS,
+    ST_NULL_TRIES, ST_NULL_CUTS,
+    ST_LMR_SEARCHES, ST_LMR_RESEARCHES,
+    ST_RAZOR_TRIES, ST_RAZOR_CUTS, ST_RFP_CUTS, ST_FUTILITY_PRUNES,
+    ST_FAIL_HIGHS, ST_FAIL_HIGH_FIRST,
+    ST_EVAL_CALLS, ST_EVAL_NS,
+    ST_GEN_CALLS, ST_GEN_NS,
+    NUM_STATS
+};
+
+struct SearchStats {
+    int64_t v[NUM_STATS] = {};
+
+    void clear() { for (int64_t& x : v) x = 0; }
+    void add(const SearchStats& o) { for (int i = 0; i < NUM_STATS; i++) v[i] += o.v[i]; }
+    // Report lines ("info string stats ..."), rates derived from the counters
+    std::string format(bool info) const;
+};
+
+// The counters of the search running on this thread (set by the searcher,
+// read by the move picker)
+extern thread_local SearchStats* threadStats;
+
+#ifdef SEARCH_STATS
+constexpr bool SEARCH_STATS_ENABLED = true;
+
+// Adds the scope's wall time to one counter and counts the call
+class StatTimer {
+public:
+    StatTimer(Stat calls, Stat ns) : calls(calls), ns(ns), start(std::chrono::steady_clock::now()) {}
+    ~StatTimer() {
+        if (!threadStats) return;
+        threadStats->v[calls]++;
+        threadStats->v[ns] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+private:
+    Stat calls, ns;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define STAT(s) (threadStats ? (void)threadStats->v[s]++ : (void)0)
+#define STAT_TIMER(calls, ns) StatTimer statTimer_(calls, ns)
+#else
+constexpr bool SEARCH_STATS_ENABLED = false;
+#define STAT(s) ((void)0)
+#define STAT_TIMER(calls, ns) ((void)0)
+#endif
@@ -0,0 +1,250 @@
+#include "selfplay.h"
+#include "tablebase.h"
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+// Adjudication: a score this large (either side) held for SP_WIN_PLIES
+// plies in a row decides the game; after SP_DRAW_PLY, a score this small
+// held for SP_DRAW_PLIES plies is a draw
+constexpr int SP_WIN_SCORE  = 1500;
+constexpr int SP_WIN_PLIES  = 6;
+constexpr int SP_DRAW_SCORE = 15;
+constexpr int SP_DRAW_PLIES = 12;
+constexpr int SP_DRAW_PLY   = 80;
+constexpr int SP_MAX_PLY    = 600;
+
+// ========================================================================
+//  Packed positions
+// ========================================================================
+void packPosition(const Board& b, int score, int result, PackedPos& p) {
+    memset(&p, 0, sizeof(p));
+    Bitboard all = b.occ[LIGHT] | b.occ[DARK];
+    p.occ = all | ((uint64_t)b.sideToMove << 63);
+    int n = 0;
+    for (Bitboard bb = all; bb; n++) {
+        int pc = b.squares[popLSB(bb)];
+        int nib = (abs(pc) - 1) | (pc < 0 ? 8 : 0);
+        p.pieces[n / 2] |= (uint8_t)(nib << (4 * (n & 1)));
+    }
+    p.score    = (int16_t)std::max(-32767, std::min(32767, score));
+    p.result   = (int8_t)result;
+    p.halfmove = (uint8_t)std::min<int>(b.halfmove, 255);
+    p.ply      = (uint16_t)std::min(b.ply, 65535);
+}
+
+bool unpackPosition(const PackedPos& p, Board& b) {
+    Bitboard all = p.occ & ALL_SQ_BB;
+    if (popcount(all) > 16) return false;
+    memset(b.squares, 0, sizeof(b.squares));
+    int n = 0;
+    for (Bitboard bb = all; bb; n++) {
+        int nib = (p.pieces[n / 2] >> (4 * (n & 1))) & 15;
+        int rk = (nib & 7) + 1;
+        b.squares[popLSB(bb)] = (int8_t)(nib & 8 ? -rk : rk);
+    }
+    b.sideToMove = (int)(p.occ >> 63);
+    // The FEN round trip rebuilds hash, piece lists and eval sums
+    if (!b.setFEN(b.toFEN())) return false;
+    b.halfmove = p.halfmove;
+    b.ply = p.ply;
+    return true;
+}
+
+// ========================================================================
+//  One game
+// ========================================================================
+int playSelfplayGame(Search& s, const SelfplayOptions& opt, int index, std::vector<PackedPos>& out) {
+    Board& b = s.board;
+    std::mt19937_64 rng(opt.seed + (uint64_t)index);
+    s.newGame();
+
+    // Random opening; retried if it ends the game
+    for (;;) {
+        b.init();
+        int i = 0;
+        for (; i < opt.randomPlies; i++) {
+            Move moves[MAX_MOVES];
+            int count = 0;
+            b.generateMoves(moves, count);
+            if (count == 0 || b.checkGameOver() != 0) break;
+            b.makeMove(moves[rng() % count]);
+        }
+        if (i == opt.randomPlies && b.checkGameOver() == 0 && b.countMoves() > 0) break;
+    }
+
+    size_t first = out.size();
+    std::vector<int> sideOf;        // side to move of each sample
+    int result = 0;                 // for Light
+    int winRun = 0, winSign = 0, drawRun = 0;
+    SearchLimits limits;
+    limits.depth = opt.depth;
+    limits.nodes = opt.depth > 0 ? 0 : opt.nodes;
+
+    for (;;) {
+        int stm = b.sideToMove;
+        int us = stm == LIGHT ? 1 : -1;
+        int over = b.checkGameOver();
+        if (over != 0)           { result = over * us; break; }
+        if (b.countMoves() == 0) { result = -us; break; }     // no moves: loss
+        if (b.halfmove >= 200 || b.isRepetition() || b.ply >= SP_MAX_PLY) break;
+
+        int tbValue;
+        if (b.pieceCount[LIGHT] + b.pieceCount[DARK] <= tbMaxPieces && tbProbe(b, tbValue)) {
+            result = tbValue > 0 ? us : tbValue < 0 ? -us : 0;
+            break;
+        }
+
+        Move best = s.think(limits);
+        if (best == MOVE_NONE) { result = -us; break; }
+        int score = s.bestLine().score;
+
+        // Adjudication, on Light's score
+        int light = score * us;
+        if (abs(light) >= SP_WIN_SCORE) {
+            int sign = light > 0 ? 1 : -1;
+            winRun = sign == winSign ? winRun + 1 : 1;
+            winSign = sign;
+        } else {
+            winRun = 0;
+        }
+        drawRun = (b.ply >= SP_DRAW_PLY && abs(light) <= SP_DRAW_SCORE) ? drawRun + 1 : 0;
+
+        // Sample quiet positions with a real evaluation
+        if (b.squares[moveTo(best)] == 0 && abs(score) < SCORE_MATE - MAX_PLY) {
+            PackedPos p;
+            packPosition(b, score, 0, p);
+            out.push_back(p);
+            sideOf.push_back(stm);
+        }
+
+        if (winRun >= SP_WIN_PLIES) { result = winSign; break; }
+        if (drawRun >= SP_DRAW_PLIES) break;
+        b.makeMove(best);
+    }
+
+    for (size_t i = first; i < out.size(); i++)
+        out[i].result = (int8_t)(sideOf[i - first] == LIGHT ? result : -result);
+    return result;
+}
+
+// ========================================================================
+//  Driver
+// ========================================================================
+// Slots take the next game index; a game whose player failed goes back to
+// `retry` for the other slots and the failed slot stops
+int64_t runSelfplayJobs(const SelfplayOptions& opt, int slots, const SelfplayGameFn& play,
+                        const char* label) {
+    FILE* f = std::fopen(opt.output.c_str(), "ab");
+    if (!f) {
+        std::printf("info string cannot write %s\n", opt.output.c_str());
+        fflush(stdout);
+        return 0;
+    }
+
+    std::mutex mtx;
+    int nextGame = 0;
+    std::vector<int> retry;
+    int gamesDone = 0;
+    int64_t positions = 0;
+    int wins[3] = {0, 0, 0};        // Light loss, draw, Light win
+    int reportEvery = std::max(1, opt.games / 20);
+    auto t0 = std::chrono::steady_clock::now();
+    auto msSince = [&]() {
+        auto t = std::chrono::steady_clock::now();
+        return (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(t - t0).count();
+    };
+
+    auto worker = [&](int slot) {
+        std::vector<PackedPos> buf;
+        for (;;) {
+            int g;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!retry.empty())              { g = retry.back(); retry.pop_back(); }
+                else if (nextGame < opt.games)   g = nextGame++;
+                else                             return;
+            }
+            buf.clear();
+            int result;
+            bool ok = play(slot, g, buf, result);
+
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!ok) { retry.push_back(g); return; }
+            std::fwrite(buf.data(), sizeof(PackedPos), buf.size(), f);
+            positions += (int64_t)buf.size();
+            wins[result + 1]++;
+            if (++gamesDone % reportEvery == 0 || gamesDone == opt.games) {
+                int64_t ms = msSince();
+                std::printf("info string selfplay games %d/%d positions %lld (%lld pos/s)\n",
+                            gamesDone, opt.games, (long long)positions,
+                            (long long)(positions * 1000 / std::max<int64_t>(ms, 1)));
+                fflush(stdout);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < slots; i++) workers.emplace_back(worker, i);
+    worker(0);
+    for (auto& w : workers) w.join();
+    std::fclose(f);
+
+    int64_t ms = msSince();
+    std::printf("Games           : %d (Light +%d =%d -%d)\n", gamesDone, wins[2], wins[1], wins[0]);
+    if (gamesDone < opt.games)
+        std::printf("Not played      : %d (every %s failed)\n", opt.games - gamesDone, label);
+    std::printf("Positions       : %lld\n", (long long)positions);
+    std::printf("Total time (ms) : %lld\n", (long long)ms);
+    std::printf("Positions/second: %lld\n", (long long)(positions * 1000 / std::max<int64_t>(ms, 1)));
+    fflush(stdout);
+    return positions;
+}
+
+int64_t runSelfplay(const SelfplayOptions& opt) {
+    int threads = std::max(1, opt.threads);
+    std::vector<std::unique_ptr<Search>> pool;
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back(new Search());
+        pool.back()->init(opt.hashMB);
+        pool.back()->silent = true;
+    }
+    SelfplayGameFn play = [&](int slot, int game, std::vector<PackedPos>& out, int& result) {
+        result = playSelfplayGame(*pool[slot], opt, game, out);
+        return true;
+    };
+    int64_t positions = runSelfplayJobs(opt, threads, play, "thread");
+    for (auto& s : pool) s->destroy();
+    return positions;
+}
+
+// ========================================================================
+//  Reader
+// ========================================================================
+void dumpSelfplayData(const std::string& path, int64_t count) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        std::printf("info string cannot open %s\n", path.c_str());
+        fflush(stdout);
+        return;
+    }
+
+    Board b;
+    PackedPos buf[1024];
+    int64_t total = 0, bad = 0, results[3] = {0, 0, 0};
+    size_t n;
+    while ((n = std::fread(buf, sizeof(PackedPos), 1024, f)) > 0) {
+        for (size_t i = 0; i < n; i++, total++) {
+            const PackedPos& p = buf[i];
+            if (p.result < -1 || p.result > 1 || !unpackPosition(p, b)) { bad++; continue; }
+            results[p.result + 1]++;
+            if (count < 0 || total < count)
+                std::printf("%s, %d, %d\n", b.toFEN().c_str(), p.score, p.result);
+        }
+    }
+    std::fclose(f);
+    std::printf("records %lld (win %lld draw %lld loss %lld for the side to move), %lld invalid\n",
+                (long long)total, (long long)results[2], (long long)results[1],
+                (long long)results[0], (long long)bad);
+    fflush(stdout);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "search.h"
+#include <functional>
+
+// ---- Self-play data generation ----
+// Games between single-threaded searchers, one per worker thread, at a
+// fixed node budget (or depth) per move. Each game starts from a random
+// opening and ends on the rules, a tablebase hit or adjudication; the
+// positions it searched (minus captures and mate scores) are written as
+// fixed-size records labelled with the search score and the game result.
+//
+// Record: occupied squares with bit 63 = Dark to move, then one nibble
+// per occupied square in square order, low nibble first: rank - 1, plus 8
+// for Dark. A board holds at most 16 pieces, so 8 bytes always suffice.
+struct PackedPos {
+    uint64_t occ;
+    uint8_t  pieces[8];
+    int16_t  score;         // search score, side to move
+    int8_t   result;        // game result, side to move: 1 win, 0 draw, -1 loss
+    uint8_t  halfmove;
+    uint16_t ply;           // game ply
+    uint16_t reserved;
+};
+static_assert(sizeof(PackedPos) == 24, "PackedPos must be 24 bytes");
+
+struct SelfplayOptions {
+    std::string output;
+    int      games       = 100;
+    int64_t  nodes       = 5000;    // per move, used when depth == 0
+    int      depth       = 0;
+    int      threads     = 1;       // concurrent games
+    size_t   hashMB      = 8;       // per game
+    int      randomPlies = 8;       // random opening moves
+    uint64_t seed        = 1;       // game i uses seed + i: any thread count
+                                    // plays the same games
+};
+
+void packPosition(const Board& b, int score, int result, PackedPos& p);
+bool unpackPosition(const PackedPos& p, Board& b);
+
+// Returns the number of positions written
+int64_t runSelfplay(const SelfplayOptions& opt);
+
+// Plays game `index` on `s` and appends its samples to `out`. Returns the
+// result for Light.
+int playSelfplayGame(Search& s, const SelfplayOptions& opt, int index, std::vector<PackedPos>& out);
+
+// Plays game `game` on player `slot`, appending its samples to `out`;
+// false if the player is gone (the game moves to another slot)
+using SelfplayGameFn = std::function<bool(int slot, int game, std::vector<PackedPos>& out, int& result)>;
+
+// The game loop of runSelfplay over `slots` players, one thread each,
+// appending to opt.output; `label` names a player in the summary
+int64_t runSelfplayJobs(const SelfplayOptions& opt, int slots, const SelfplayGameFn& play,
+                        const char* label);
+
+// Prints the first `count` records of a data file as "fen, score, result"
+// (all of them if count < 0), then the record and result totals
+void dumpSelfplayData(const std::string& path, int64_t count);
@@ -0,0 +1,435 @@
+#include "tablebase.h"
+#include "mapfile.h"
+#include "tables.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+int tbMaxPieces = 0;
+
+// ========================================================================
+//  Material and indexing
+// ========================================================================
+// mask[c] bit r-1 set = colour c has rank r
+struct TBMaterial {
+    uint8_t mask[2];
+    uint16_t key() const { return (uint16_t)(mask[0] | (mask[1] << 8)); }
+    int pieces() const { return popcount(mask[0]) + popcount(mask[1]); }
+};
+
+// Stored orientation: more pieces for Light, ties broken by the masks
+static bool isCanonical(const TBMaterial& m) {
+    int l = popcount(m.mask[0]), d = popcount(m.mask[1]);
+    return l > d || (l == d && m.mask[0] >= m.mask[1]);
+}
+
+static TBMaterial flipped(const TBMaterial& m) {
+    return TBMaterial{{m.mask[1], m.mask[0]}};
+}
+
+static TBMaterial materialOf(const int8_t pieceSq[2][NUM_PIECE_TYPES]) {
+    TBMaterial m{{0, 0}};
+    for (int c = 0; c < 2; c++)
+        for (int rk = 1; rk <= 8; rk++)
+            if (pieceSq[c][rk] >= 0) m.mask[c] |= (uint8_t)(1 << (rk - 1));
+    return m;
+}
+
+static std::string materialName(const TBMaterial& m) {
+    std::string s;
+    for (int rk = 8; rk >= 1; rk--) if (m.mask[0] & (1 << (rk - 1))) s += pieceChar(rk, LIGHT);
+    s += 'v';
+    for (int rk = 8; rk >= 1; rk--) if (m.mask[1] & (1 << (rk - 1))) s += pieceChar(rk, DARK);
+    return s;
+}
+
+// Square slots per piece kind: [color][isRat][sq] -> slot, -1 = not allowed
+static int8_t sqSlot[2][2][NUM_SQ];
+static int8_t slotSq[2][2][NUM_SQ];
+static int    slotCount[2][2];
+
+static void initSlots() {
+    static bool done = false;
+    if (done) return;
+    for (int c = 0; c < 2; c++) {
+        int ownDen = (c == LIGHT) ? DEN_LIGHT_SQ : DEN_DARK_SQ;
+        for (int rat = 0; rat < 2; rat++) {
+            int n = 0;
+            for (int sq = 0; sq < NUM_SQ; sq++) {
+                bool ok = sq != ownDen && (rat || !isWater[sq]);
+                sqSlot[c][rat][sq] = ok ? (int8_t)n : -1;
+                if (ok) slotSq[c][rat][n++] = (int8_t)sq;
+            }
+            slotCount[c][rat] = n;
+        }
+    }
+    done = true;
+}
+
+// Piece layout of one table
+struct TBLayout {
+    TBMaterial mat{{0, 0}};
+    int    n = 0;
+    int8_t color[TB_MAX_PIECES], rank[TB_MAX_PIECES];
+    uint64_t stride[TB_MAX_PIECES];     // index weight of each piece's slot
+    uint64_t entries = 0;
+
+    TBLayout() = default;
+    explicit TBLayout(const TBMaterial& m) : mat(m) {
+        for (int c = 0; c < 2; c++)
+            for (int rk = 1; rk <= 8; rk++)
+                if (m.mask[c] & (1 << (rk - 1))) { color[n] = (int8_t)c; rank[n] = (int8_t)rk; n++; }
+        uint64_t s = 2;                 // lowest bit is the side to move
+        for (int i = n - 1; i >= 0; i--) {
+            stride[i] = s;
+            s *= slotCount[color[i]][rank[i] == RAT];
+        }
+        entries = s;
+    }
+
+    uint64_t index(const int8_t pieceSq[2][NUM_PIECE_TYPES], int stm) const {
+        uint64_t idx = (uint64_t)stm;
+        for (int i = 0; i < n; i++)
+            idx += stride[i] * (uint64_t)sqSlot[color[i]][rank[i] == RAT][pieceSq[color[i]][rank[i]]];
+        return idx;
+    }
+
+    // Fills pieceSq and returns the side to move; false if pieces overlap
+    bool decode(uint64_t idx, int8_t pieceSq[2][NUM_PIECE_TYPES], int& stm) const {
+        memset(pieceSq, -1, 2 * NUM_PIECE_TYPES);
+        stm = (int)(idx & 1);
+        Bitboard seen = 0;
+        for (int i = 0; i < n; i++) {
+            int slot = (int)((idx / stride[i]) % slotCount[color[i]][rank[i] == RAT]);
+            int sq = slotSq[color[i]][rank[i] == RAT][slot];
+            if (seen & sqBB(sq)) return false;
+            seen |= sqBB(sq);
+            pieceSq[color[i]][rank[i]] = (int8_t)sq;
+        }
+        return true;
+    }
+};
+
+// ========================================================================
+//  Loaded tables
+// ========================================================================
+struct TBTable {
+    TBLayout layout;
+    const int8_t* data = nullptr;
+    MappedFile file;
+    int      pieces = 0;
+};
+
+constexpr size_t TB_HEADER = 8;
+
+static std::unordered_map<uint16_t, TBTable> tables;
+
+static std::string tablePath(const std::string& dir, const TBMaterial& m) {
+    std::string p = dir.empty() ? std::string(".") : dir;
+    if (p.back() != '/' && p.back() != '\\') p += '/';
+    return p + materialName(m) + ".jtb";
+}
+
+static bool loadTable(const std::string& file, const TBMaterial& m) {
+    TBLayout layout(m);
+    MappedFile mf;
+    if (!mf.open(file)) return false;
+    const uint8_t* hdr = (const uint8_t*)mf.data;
+    uint32_t magic = 0;
+    if (mf.size == TB_HEADER + layout.entries) memcpy(&magic, hdr, sizeof(magic));
+    if (magic != TB_MAGIC || hdr[4] != m.mask[0] || hdr[5] != m.mask[1]) {
+        mf.close();
+        return false;
+    }
+
+    TBTable& t = tables[m.key()];
+    t.file.close();
+    t.file    = mf;
+    t.layout  = layout;
+    t.data    = (const int8_t*)hdr + TB_HEADER;
+    t.pieces  = m.pieces();
+    tbMaxPieces = std::max(tbMaxPieces, t.pieces);
+    return true;
+}
+
+void tbFree() {
+    for (auto& kv : tables) kv.second.file.close();
+    tables.clear();
+    tbMaxPieces = 0;
+}
+
+// Calls fn for every canonical material of exactly `pieces` pieces
+template <typename Fn>
+static void forEachMaterial(int pieces, Fn fn) {
+    for (int l = 1; l < 256; l++)
+        for (int d = 1; d < 256; d++) {
+            TBMaterial m{{(uint8_t)l, (uint8_t)d}};
+            if (m.pieces() == pieces && isCanonical(m)) fn(m);
+        }
+}
+
+int tbInit(const std::string& path) {
+    initSlots();
+    tbFree();
+    int count = 0;
+    for (int k = 2; k <= TB_MAX_PIECES; k++)
+        forEachMaterial(k, [&](const TBMaterial& m) {
+            if (loadTable(tablePath(path, m), m)) count++;
+        });
+    return count;
+}
+
+// ========================================================================
+//  Probing
+// ========================================================================
+// Raw probe by piece placement; false if the table is not loaded
+static bool probeRaw(const int8_t pieceSq[2][NUM_PIECE_TYPES], int stm, int& value) {
+    TBMaterial m = materialOf(pieceSq);
+    if (isCanonical(m)) {
+        auto it = tables.find(m.key());
+        if (it == tables.end()) return false;
+        value = it->second.data[it->second.layout.index(pieceSq, stm)];
+        return true;
+    }
+    // Stored with colours swapped: rotate the board 180 degrees
+    TBMaterial fm = flipped(m);
+    auto it = tables.find(fm.key());
+    if (it == tables.end()) return false;
+    int8_t fsq[2][NUM_PIECE_TYPES];
+    for (int c = 0; c < 2; c++)
+        for (int rk = 0; rk < NUM_PIECE_TYPES; rk++)
+            fsq[c][rk] = pieceSq[1 - c][rk] >= 0 ? (int8_t)(NUM_SQ - 1 - pieceSq[1 - c][rk]) : -1;
+    value = it->second.data[it->second.layout.index(fsq, 1 - stm)];
+    return true;
+}
+
+bool tbProbe(const Board& b, int& value) {
+    if (b.pieceCount[0] + b.pieceCount[1] > tbMaxPieces) return false;
+    return probeRaw(b.pieceSq, b.sideToMove, value);
+}
+
+// ========================================================================
+//  Generation (retrograde)
+// ========================================================================
+// Positions are resolved in order of distance. A loss at distance d makes
+// every predecessor a win at d + 1; a win at d decrements each
+// predecessor's count of moves not yet known to lose, and a predecessor
+// whose count reaches zero is lost at one more than its longest win for
+// the opponent. Captures lead to smaller, already solved tables and are
+// folded in before propagation starts. Predecessors are found by
+// un-moving the side that just moved: Jungle moves are reversible (steps
+// and jumps are symmetric, with the same water blockers), so they are
+// exactly that side's quiet moves.
+//
+// Working memory is 4 bytes per entry (about 60 MB for 4 pieces with a
+// rat, 4 GB for 5).
+
+// Sets up just what move generation needs
+static void placePieces(Board& b, const int8_t pieceSq[2][NUM_PIECE_TYPES], int stm) {
+    memset(b.squares, 0, sizeof(b.squares));
+    memcpy(b.pieceSq, pieceSq, sizeof(b.pieceSq));
+    for (int c = 0; c < 2; c++) {
+        b.pieceCount[c] = 0;
+        b.occ[c] = 0;
+        for (int rk = 1; rk <= 8; rk++) {
+            int sq = pieceSq[c][rk];
+            if (sq < 0) continue;
+            b.squares[sq] = (int8_t)(c == LIGHT ? rk : -rk);
+            b.occ[c] |= sqBB(sq);
+            b.pieceCount[c]++;
+        }
+    }
+    b.sideToMove = stm;
+}
+
+static inline int16_t encWin(int d)  { return (int16_t)d; }
+static inline int16_t encLoss(int d) { return (int16_t)(-d - 1); }
+
+static bool generateTable(const TBMaterial& m, const std::string& path) {
+    auto t0 = std::chrono::steady_clock::now();
+    TBLayout L(m);
+    const uint64_t N = L.entries;
+
+    std::vector<int16_t> val(N, 0);
+    std::vector<uint8_t> remaining(N, 0);
+    std::vector<uint8_t> maxWin(N, 0);
+    std::vector<std::vector<uint32_t>> levels(2);   // (index << 1) | isWin
+
+    auto push = [&](int level, uint64_t idx, bool win) {
+        if ((size_t)level >= levels.size()) levels.resize(level + 1);
+        levels[level].push_back((uint32_t)((idx << 1) | (win ? 1 : 0)));
+    };
+
+    Board b;
+    int8_t ps[2][NUM_PIECE_TYPES];
+    Move moves[MAX_MOVES];
+    int stm;
+
+    // ---- Terminal positions and captures into smaller tables ----
+    for (uint64_t idx = 0; idx < N; idx++) {
+        if (!L.decode(idx, ps, stm)) continue;
+        int opp = 1 - stm;
+        int ownDen = (stm == LIGHT) ? DEN_LIGHT_SQ : DEN_DARK_SQ;
+        int oppDen = (stm == LIGHT) ? DEN_DARK_SQ : DEN_LIGHT_SQ;
+        placePieces(b, ps, stm);
+        if (b.occ[opp] & sqBB(ownDen)) { push(0, idx, false); continue; }
+        if (b.occ[stm] & sqBB(oppDen)) { push(1, idx, true); continue; }  // unreachable
+
+        int count = 0;
+        b.generateMoves(moves, count);
+        int bestWin = 0, longest = 0, open = 0;
+        for (int i = 0; i < count; i++) {
+            int from = moveFrom(moves[i]), to = moveTo(moves[i]);
+            int victim = b.squares[to];
+            if (victim == 0) { open++; continue; }
+
+            int v;
+            if (b.pieceCount[opp] == 1) {
+                v = encLoss(0);             // last enemy piece taken
+            } else {
+                int8_t cs[2][NUM_PIECE_TYPES];
+                memcpy(cs, ps, sizeof(cs));
+                cs[opp][abs(victim)] = -1;
+                cs[stm][abs(b.squares[from])] = (int8_t)to;
+                if (!probeRaw(cs, opp, v)) {
+                    std::printf("info string tbgen %s: missing subtable\n", materialName(m).c_str());
+                    return false;
+                }
+            }
+            if (v > 0) {
+                longest = std::max(longest, v);
+                continue;
+            }
+            if (v < 0 && (!bestWin || -v < bestWin)) bestWin = -v;   // loss in -v - 1
+            open++;                         // drawn or winning: never counts down
+        }
+        if (bestWin) push(bestWin, idx, true);
+        remaining[idx] = (uint8_t)open;
+        maxWin[idx] = (uint8_t)std::min(longest, 255);
+        if (count == 0) push(0, idx, false);                // no moves: lost
+        else if (open == 0) push(longest + 1, idx, false);
+    }
+
+    // ---- Propagation in order of distance ----
+    int maxDist = 0;
+    for (size_t level = 0; level < levels.size(); level++) {
+        for (size_t k = 0; k < levels[level].size(); k++) {
+            uint32_t e = levels[level][k];
+            uint64_t idx = e >> 1;
+            bool win = e & 1;
+            if (val[idx] != 0) continue;    // resolved at a shorter distance
+            val[idx] = win ? encWin((int)level) : encLoss((int)level);
+            maxDist = (int)level;
+
+            // Predecessors: the side that just moved takes a quiet move back
+            L.decode(idx, ps, stm);
+            int mover = 1 - stm;
+            placePieces(b, ps, mover);
+            int count = 0;
+            b.generateQuiets(moves, count);
+            for (int i = 0; i < count; i++) {
+                int from = moveFrom(moves[i]), to = moveTo(moves[i]);
+                int rk = abs(b.squares[from]);
+                ps[mover][rk] = (int8_t)to;
+                uint64_t pred = L.index(ps, mover);
+                ps[mover][rk] = (int8_t)from;
+                if (val[pred] != 0) continue;
+                if (!win) {
+                    push((int)level + 1, pred, true);
+                } else {
+                    maxWin[pred] = (uint8_t)std::max<int>(maxWin[pred], std::min<int>((int)level, 255));
+                    if (--remaining[pred] == 0) push(maxWin[pred] + 1, pred, false);
+                }
+            }
+        }
+        std::vector<uint32_t>().swap(levels[level]);
+    }
+
+    // ---- Write ----
+    std::string file = tablePath(path, m);
+    FILE* f = std::fopen(file.c_str(), "wb");
+    if (!f) {
+        std::printf("info string tbgen cannot write %s\n", file.c_str());
+        return false;
+    }
+    uint8_t hdr[TB_HEADER] = {0};
+    memcpy(hdr, &TB_MAGIC, sizeof(TB_MAGIC));
+    hdr[4] = m.mask[0];
+    hdr[5] = m.mask[1];
+    std::vector<int8_t> out(N);
+    uint64_t wins = 0, losses = 0, draws = 0;
+    for (uint64_t idx = 0; idx < N; idx++) {
+        int v = val[idx];
+        out[idx] = (int8_t)std::max(-128, std::min(127, v));
+        int tmp;
+        if (!L.decode(idx, ps, tmp)) continue;
+        if (v > 0) wins++; else if (v < 0) losses++; else draws++;
+    }
+    bool ok = std::fwrite(hdr, 1, TB_HEADER, f) == TB_HEADER
+           && std::fwrite(out.data(), 1, N, f) == N;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || !loadTable(file, m)) {
+        std::printf("info string tbgen failed writing %s\n", file.c_str());
+        return false;
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+    std::printf("info string tbgen %s entries %llu win %llu draw %llu loss %llu maxdtm %d time %lld\n",
+                materialName(m).c_str(), (unsigned long long)N, (unsigned long long)wins,
+                (unsigned long long)draws, (unsigned long long)losses, maxDist,
+                (long long)std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count());
+    fflush(stdout);
+    return true;
+}
+
+// Generates `m` (canonical) after every table a capture can lead to
+static bool generateWithDeps(const TBMaterial& m, const std::string& path) {
+    if (tables.count(m.key())) return true;
+    for (int c = 0; c < 2; c++) {
+        if (popcount(m.mask[c]) < 2) continue;      // capturing the last piece ends the game
+        for (int rk = 1; rk <= 8; rk++) {
+            if (!(m.mask[c] & (1 << (rk - 1)))) continue;
+            TBMaterial sub = m;
+            sub.mask[c] &= (uint8_t)~(1 << (rk - 1));
+            if (!isCanonical(sub)) sub = flipped(sub);
+            if (!generateWithDeps(sub, path)) return false;
+        }
+    }
+    return generateTable(m, path);
+}
+
+static bool parseMaterial(const std::string& s, TBMaterial& m) {
+    m = TBMaterial{{0, 0}};
+    int side = LIGHT;
+    for (char ch : s) {
+        if (ch == 'v' || ch == 'V') { if (side == DARK) return false; side = DARK; continue; }
+        int rk = charToRank(ch);
+        if (rk <= 0 || (m.mask[side] & (1 << (rk - 1)))) return false;
+        m.mask[side] |= (uint8_t)(1 << (rk - 1));
+    }
+    return side == DARK && m.mask[0] && m.mask[1] && m.pieces() <= TB_MAX_PIECES;
+}
+
+bool tbGenerate(const std::string& spec, const std::string& path) {
+    initSlots();
+    if (!spec.empty() && isdigit((unsigned char)spec[0])) {
+        int maxPieces = std::min(std::stoi(spec), TB_MAX_PIECES);
+        bool ok = true;
+        for (int k = 2; k <= maxPieces && ok; k++)
+            forEachMaterial(k, [&](const TBMaterial& m) {
+                if (ok) ok = generateWithDeps(m, path);
+            });
+        return ok;
+    }
+    TBMaterial m;
+    if (!parseMaterial(spec, m)) {
+        std::printf("info string tbgen: bad material '%s'\n", spec.c_str());
+        return false;
+    }
+    if (!isCanonical(m)) m = flipped(m);
+    return generateWithDeps(m, path);
+}
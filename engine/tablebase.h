@@ -0,0 +1,44 @@
+#pragma once
+#include "board.h"
+
+// ---- Endgame tablebases ----
+// One file per material combination, e.g. "LTvr.jtb" = Light lion + tiger
+// against a Dark rat. Only one colour orientation is stored: the other is
+// probed by rotating the board 180 degrees and swapping colours.
+//
+// Entries are int8 distance-to-mate for the side to move, in plies:
+//   0 = draw,  +d = win in d plies,  -(d + 1) = loss in d plies
+// Distances saturate at 127 / 128 plies. The 200 half-move rule is ignored.
+//
+// Index: each piece (Light ranks ascending, then Dark) contributes its slot
+// among the squares it may stand on (rats: all but the own den, others
+// also no water), mixed radix, then * 2 + side to move. Overlapping pieces
+// leave unused (draw) entries.
+//
+// File format: uint32 magic 'JTB1', uint8 light mask, uint8 dark mask
+// (bit r-1 = rank r present), uint16 reserved, then the int8 entries.
+constexpr int      TB_MAX_PIECES = 5;
+constexpr uint32_t TB_MAGIC      = 0x3142544A;   // "JTB1"
+
+// Pieces of the largest loaded table, 0 when none are loaded
+extern int tbMaxPieces;
+
+// Loads (memory-maps) every table found in `path`; returns the file count
+int  tbInit(const std::string& path);
+void tbFree();
+
+// Probes the position; false if no table covers it
+bool tbProbe(const Board& b, int& value);
+
+// Generates missing tables into `path`: "4" = every material up to 4
+// pieces, "LTvr" = one material plus the smaller tables it needs.
+// Generated tables are loaded as they are written.
+bool tbGenerate(const std::string& spec, const std::string& path);
+
+// Search score of a probed value at `ply`
+inline int tbScore(int value, int ply) {
+    if (value == 0) return SCORE_DRAW;
+    int dist = value > 0 ? value : -value - 1;
+    int matePly = std::min(ply + dist, MAX_PLY - 1);
+    return value > 0 ? SCORE_MATE - matePly : -(SCORE_MATE - matePly);
+}
@@ -0,0 +1,253 @@
+#pragma once
+#include "types.h"
+
+// ---- Board tables, computed at compile time ----
+// Terrain, river jumps, step masks, Zobrist keys and the BFS distance
+// tables are constexpr: nothing to build at startup, and the compiler sees
+// them as constants in move generation and evaluation.
+
+// Jump table for lion/tiger
+struct JumpEntry {
+    int from, to;
+    int blocking[3];   // water squares to check for rats
+    int numBlocking;
+};
+constexpr int MAX_JUMPS = 40;
+
+// Jump lookup per square
+constexpr int MAX_JUMPS_PER_SQ = 4;
+struct SqJumps {
+    int dest[MAX_JUMPS_PER_SQ];
+    int blockStart[MAX_JUMPS_PER_SQ]; // index into blocking squares
+    int blockCount[MAX_JUMPS_PER_SQ];
+    int blockingSqs[MAX_JUMPS_PER_SQ * 3]; // flattened
+    Bitboard blockMask[MAX_JUMPS_PER_SQ];  // water squares a rat could block
+    int count;
+};
+
+struct BoardTables {
+    int  terrain[NUM_SQ];
+    bool isWater[NUM_SQ];
+    int  distLand[2][NUM_SQ];       // [den_side][sq] shortest distance on land
+    int  distJumper[2][NUM_SQ];     // [den_side][sq] shortest distance with jumps
+    int  distSwimmer[2][NUM_SQ];    // [den_side][sq] shortest distance through water
+
+    JumpEntry jumpTable[MAX_JUMPS];
+    int       numJumps;
+    SqJumps   sqJumpLookup[NUM_SQ];
+
+    // Bitboard masks
+    Bitboard waterBB;
+    Bitboard trapBB[2];             // [color] own traps (enemy pieces on them are weakened)
+    Bitboard denBB[2];              // [color] own den
+    Bitboard stepBB[NUM_SQ];        // orthogonal neighbours
+    Bitboard denNearBB[2][3];       // [color] squares at distance <= 1, 2, 3 from its den
+    int8_t   sqDistance[NUM_SQ][NUM_SQ]; // Manhattan distance
+
+    // Zobrist keys
+    uint64_t zobristPiece[NUM_SQ][NUM_PIECE_TYPES][2]; // [sq][rank][color]
+    uint64_t zobristSide;
+};
+
+// std::mt19937_64, usable in constant expressions: the Zobrist keys stay
+// the ones the runtime generator produced (books and saved hashes keep
+// working)
+class ConstexprMt64 {
+public:
+    constexpr explicit ConstexprMt64(uint64_t seed) : mt(), idx(N) {
+        mt[0] = seed;
+        for (int i = 1; i < N; i++)
+            mt[i] = 6364136223846793005ULL * (mt[i - 1] ^ (mt[i - 1] >> 62)) + (uint64_t)i;
+    }
+    constexpr uint64_t operator()() {
+        if (idx >= N) twist();
+        uint64_t x = mt[idx++];
+        x ^= (x >> 29) & 0x5555555555555555ULL;
+        x ^= (x << 17) & 0x71D67FFFEDA60000ULL;
+        x ^= (x << 37) & 0xFFF7EEE000000000ULL;
+        x ^= x >> 43;
+        return x;
+    }
+private:
+    static constexpr int N = 312, M = 156;
+    uint64_t mt[N];
+    int idx;
+
+    constexpr void twist() {
+        for (int i = 0; i < N; i++) {
+            uint64_t x = (mt[i] & 0xFFFFFFFF80000000ULL) | (mt[(i + 1) % N] & 0x7FFFFFFFULL);
+            uint64_t xA = x >> 1;
+            if (x & 1) xA ^= 0xB5026F5AA96619E9ULL;
+            mt[i] = mt[(i + M) % N] ^ xA;
+        }
+        idx = 0;
+    }
+};
+
+// BFS distance from a den. type 0 = land-only, type 1 = jumper (land +
+// jumps), type 2 = swimmer (land + water)
+constexpr void computeBFS(const BoardTables& t, int denSq, int type, int* dist) {
+    int queue[NUM_SQ * 4] = {};
+    int head = 0, tail = 0;
+    for (int i = 0; i < NUM_SQ; i++) dist[i] = 99;
+    dist[denSq] = 0;
+    queue[tail++] = denSq;
+
+    while (head < tail) {
+        int sq = queue[head++];
+        int nd = dist[sq] + 1;
+
+        // Normal 4-directional moves
+        for (int d : DIRS) {
+            if (!canStep(sq, d)) continue;
+            int ns = sq + d;
+            if (type != 2 && t.isWater[ns]) continue;   // only the swimmer enters water
+            if (nd < dist[ns]) { dist[ns] = nd; queue[tail++] = ns; }
+        }
+
+        // Jumps (type 1 = jumper)
+        if (type == 1) {
+            const SqJumps& sj = t.sqJumpLookup[sq];
+            for (int i = 0; i < sj.count; i++) {
+                int ns = sj.dest[i];
+                if (nd < dist[ns]) { dist[ns] = nd; queue[tail++] = ns; }
+            }
+        }
+    }
+}
+
+constexpr BoardTables makeBoardTables() {
+    BoardTables t{};
+
+    // ---- Terrain ----
+    for (int sq = 0; sq < NUM_SQ; sq++) { t.terrain[sq] = TERRAIN_LAND; t.isWater[sq] = false; }
+
+    // Water squares
+    const int waterSqs[] = {22,23,29,30,36,37, 25,26,32,33,39,40};
+    for (int sq : waterSqs) { t.terrain[sq] = TERRAIN_WATER; t.isWater[sq] = true; }
+
+    // Dens
+    t.terrain[DEN_LIGHT_SQ] = TERRAIN_DEN_LIGHT;
+    t.terrain[DEN_DARK_SQ]  = TERRAIN_DEN_DARK;
+
+    // Traps
+    const int lightTraps[] = { makeSq(0,2), makeSq(0,4), makeSq(1,3) }; // C1, E1, D2
+    const int darkTraps[]  = { makeSq(8,2), makeSq(8,4), makeSq(7,3) }; // C9, E9, D8
+    for (int sq : lightTraps) t.terrain[sq] = TERRAIN_TRAP_LIGHT;
+    for (int sq : darkTraps)  t.terrain[sq] = TERRAIN_TRAP_DARK;
+
+    // ---- Jump table ----
+    t.numJumps = 0;
+    auto addJump = [&](int from, int to, int b1, int b2, int b3) {
+        JumpEntry& e = t.jumpTable[t.numJumps++];
+        e.from = from; e.to = to;
+        e.numBlocking = 0;
+        for (int b : { b1, b2, b3 })
+            if (b >= 0) e.blocking[e.numBlocking++] = b;
+    };
+
+    // Left river horizontal jumps (cols B-C = 1,2;  rows 4-6 = index 3-5)
+    for (int r = 3; r <= 5; r++) {
+        int a = makeSq(r,0), b1 = makeSq(r,1), b2 = makeSq(r,2), d = makeSq(r,3);
+        addJump(a, d, b1, b2, -1);   // A->D east
+        addJump(d, a, b2, b1, -1);   // D->A west
+    }
+    // Right river horizontal jumps (cols E-F = 4,5;  rows 4-6)
+    for (int r = 3; r <= 5; r++) {
+        int d = makeSq(r,3), e1 = makeSq(r,4), e2 = makeSq(r,5), g = makeSq(r,6);
+        addJump(d, g, e1, e2, -1);   // D->G east
+        addJump(g, d, e2, e1, -1);   // G->D west
+    }
+    // Left river vertical jumps (cols B,C; rows 3->7 over rows 4,5,6)
+    for (int c = 1; c <= 2; c++) {
+        int bot = makeSq(2,c), top = makeSq(6,c);
+        int w1 = makeSq(3,c), w2 = makeSq(4,c), w3 = makeSq(5,c);
+        addJump(bot, top, w1, w2, w3); // row3 -> row7 north
+        addJump(top, bot, w3, w2, w1); // row7 -> row3 south
+    }
+    // Right river vertical jumps (cols E,F)
+    for (int c = 4; c <= 5; c++) {
+        int bot = makeSq(2,c), top = makeSq(6,c);
+        int w1 = makeSq(3,c), w2 = makeSq(4,c), w3 = makeSq(5,c);
+        addJump(bot, top, w1, w2, w3);
+        addJump(top, bot, w3, w2, w1);
+    }
+
+    // Build per-square jump lookup
+    for (int i = 0; i < t.numJumps; i++) {
+        const JumpEntry& e = t.jumpTable[i];
+        SqJumps& sj = t.sqJumpLookup[e.from];
+        int idx = sj.count;
+        sj.dest[idx] = e.to;
+        sj.blockStart[idx] = (idx > 0) ? sj.blockStart[idx-1] + sj.blockCount[idx-1] : 0;
+        sj.blockCount[idx] = e.numBlocking;
+        sj.blockMask[idx] = 0;
+        for (int j = 0; j < e.numBlocking; j++) {
+            sj.blockingSqs[sj.blockStart[idx] + j] = e.blocking[j];
+            sj.blockMask[idx] |= sqBB(e.blocking[j]);
+        }
+        sj.count++;
+    }
+
+    // ---- Bitboard masks ----
+    for (int sq = 0; sq < NUM_SQ; sq++) {
+        if (t.isWater[sq]) t.waterBB |= sqBB(sq);
+        if (t.terrain[sq] == TERRAIN_TRAP_LIGHT) t.trapBB[LIGHT] |= sqBB(sq);
+        if (t.terrain[sq] == TERRAIN_TRAP_DARK)  t.trapBB[DARK]  |= sqBB(sq);
+        for (int d : DIRS)
+            if (canStep(sq, d)) t.stepBB[sq] |= sqBB(sq + d);
+    }
+    t.denBB[LIGHT] = sqBB(DEN_LIGHT_SQ);
+    t.denBB[DARK]  = sqBB(DEN_DARK_SQ);
+
+    // ---- Distances ----
+    for (int a = 0; a < NUM_SQ; a++)
+        for (int b = 0; b < NUM_SQ; b++) {
+            int dr = sqRow(a) - sqRow(b), dc = sqCol(a) - sqCol(b);
+            t.sqDistance[a][b] = (int8_t)((dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc));
+        }
+    for (int c = 0; c < 2; c++) {
+        int denSq = (c == LIGHT) ? DEN_LIGHT_SQ : DEN_DARK_SQ;
+        for (int sq = 0; sq < NUM_SQ; sq++) {
+            int d = t.sqDistance[denSq][sq];
+            if (d <= 3) t.denNearBB[c][d <= 1 ? 0 : d - 1] |= sqBB(sq);
+        }
+    }
+
+    // ---- Zobrist keys ----
+    ConstexprMt64 rng(0xDEADBEEF42ULL);
+    for (int sq = 0; sq < NUM_SQ; sq++)
+        for (int rk = 1; rk < NUM_PIECE_TYPES; rk++)
+            for (int c = 0; c < 2; c++)
+                t.zobristPiece[sq][rk][c] = rng();
+    t.zobristSide = rng();
+
+    // ---- BFS distance tables ----
+    for (int den = 0; den < 2; den++) {
+        int denSq = (den == 0) ? DEN_LIGHT_SQ : DEN_DARK_SQ;
+        computeBFS(t, denSq, 0, t.distLand[den]);
+        computeBFS(t, denSq, 1, t.distJumper[den]);
+        computeBFS(t, denSq, 2, t.distSwimmer[den]);
+    }
+    return t;
+}
+
+inline constexpr BoardTables BOARD_TABLES = makeBoardTables();
+
+// The tables under their usual names
+inline constexpr const auto& terrain      = BOARD_TABLES.terrain;
+inline constexpr const auto& isWater      = BOARD_TABLES.isWater;
+inline constexpr const auto& distLand     = BOARD_TABLES.distLand;
+inline constexpr const auto& distJumper   = BOARD_TABLES.distJumper;
+inline constexpr const auto& distSwimmer  = BOARD_TABLES.distSwimmer;
+inline constexpr const auto& jumpTable    = BOARD_TABLES.jumpTable;
+inline constexpr int          numJumps    = BOARD_TABLES.numJumps;
+inline constexpr const auto& sqJumpLookup = BOARD_TABLES.sqJumpLookup;
+inline constexpr Bitboard     waterBB     = BOARD_TABLES.waterBB;
+inline constexpr const auto& trapBB       = BOARD_TABLES.trapBB;
+inline constexpr const auto& denBB        = BOARD_TABLES.denBB;
+inline constexpr const auto& stepBB       = BOARD_TABLES.stepBB;
+inline constexpr const auto& denNearBB    = BOARD_TABLES.denNearBB;
+inline constexpr const auto& sqDistance   = BOARD_TABLES.sqDistance;
+inline constexpr const auto& zobristPiece = BOARD_TABLES.zobristPiece;
+inline constexpr uint64_t     zobristSide = BOARD_TABLES.zobristSide;
@@ -0,0 +1,59 @@
+#include "timeman.h"
+#include <algorithm>
+
+// ========================================================================
+//  Allocation
+// ========================================================================
+void TimeManager::init(const SearchLimits& limits, int stm) {
+    lastBest = MOVE_NONE;
+    lastScore = 0;
+    instability = 0;
+    fixed = false;
+    active = !limits.infinite && (limits.movetime > 0 || limits.hasClock());
+    if (!active) return;
+
+    if (limits.movetime > 0) {
+        fixed   = true;
+        maximum = std::max<int64_t>(1, limits.movetime - MOVE_OVERHEAD / 3);
+        optimum = maximum;
+        return;
+    }
+
+    int64_t time = std::max<int64_t>(1, limits.time[stm]);
+    int64_t inc  = limits.inc[stm];
+    int     mtg  = limits.movestogo > 0 ? std::min(limits.movestogo, 50) : 40;
+
+    // Time we can spend over the next `mtg` moves, keeping the overhead
+    // of each move in reserve
+    int64_t avail = std::max<int64_t>(1, time + inc * (mtg - 1) - MOVE_OVERHEAD * mtg);
+    optimum = avail / mtg;
+    if (limits.movestogo == 1) optimum = avail * 4 / 5;
+
+    // Never plan to use more than 80% of the clock on one move
+    int64_t cap = std::max<int64_t>(1, time * 4 / 5 - MOVE_OVERHEAD);
+    maximum = std::min(cap, optimum * 5);
+    optimum = std::min(optimum, maximum);
+}
+
+// ========================================================================
+//  Per-iteration scaling
+// ========================================================================
+bool TimeManager::iterationDone(int depth, int64_t elapsedMs, Move best, int score, bool failedLow) {
+    if (!active) return false;
+
+    bool changed = depth > 1 && best != lastBest;
+    instability = instability * 0.5 + (changed ? 1.0 : 0.0);
+    int drop = lastScore - score;
+    lastBest  = best;
+    lastScore = score;
+    if (fixed) return elapsedMs >= optimum * 2 / 5;
+    if (depth < 4) return false;
+
+    double scale = 0.6 + 0.6 * instability;             // 0.6 when settled
+    if (drop > 30)  scale *= 1.0 + std::min(drop, 200) / 200.0;
+    if (failedLow)  scale *= 1.4;
+    int64_t soft = std::min<int64_t>(maximum, (int64_t)(optimum * scale));
+
+    // The next iteration typically takes longer than all previous ones
+    return elapsedMs >= soft / 2;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "types.h"
+#include <vector>
+
+// ---- Search limits (from "go") ----
+struct SearchLimits {
+    int     depth     = 0;          // 0 = no depth limit
+    int64_t movetime  = 0;          // fixed time per move, ms
+    int64_t time[2]   = {0, 0};     // remaining clock per colour (wtime/btime)
+    int64_t inc[2]    = {0, 0};     // increment per colour (winc/binc)
+    int     movestogo = 0;          // moves to the next time control, 0 = sudden death
+    bool    infinite  = false;      // search until "stop"
+    bool    ponder    = false;      // go ponder: untimed until "ponderhit"
+    int64_t nodes     = 0;          // node budget of the main thread, 0 = none
+    std::vector<Move> searchMoves;  // root moves to consider, empty = all
+
+    bool hasClock() const { return time[LIGHT] > 0 || time[DARK] > 0; }
+};
+
+// ---- Time manager ----
+// Soft limit: the time the move should take on average, scaled after each
+// iteration by how settled the search is (stable best move and score
+// shrink it; best-move changes, score drops and fail-lows grow it). A new
+// iteration is not started past half of it. Hard limit: checked during
+// the search, a fraction of the remaining clock.
+class TimeManager {
+public:
+    static constexpr int64_t MOVE_OVERHEAD = 30;   // ms lost to I/O per move
+
+    void init(const SearchLimits& limits, int stm);
+
+    // After a completed iteration; true = do not start the next one
+    bool iterationDone(int depth, int64_t elapsedMs, Move best, int score, bool failedLow);
+
+    bool    enabled()   const { return active; }
+    int64_t hardLimit() const { return maximum; }
+    int64_t softLimit() const { return optimum; }
+
+private:
+    bool    active  = false;
+    bool    fixed   = false;        // go movetime: no scaling
+    int64_t optimum = 0;            // base soft limit
+    int64_t maximum = 0;            // hard limit
+    Move    lastBest  = MOVE_NONE;
+    int     lastScore = 0;
+    double  instability = 0;        // decaying count of best-move changes
+};
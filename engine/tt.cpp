@@ -0,0 +1,322 @@
+#include "tt.h"
+#include "mapfile.h"
+#include "tables.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+// ========================================================================
+//  Slot packing
+// ========================================================================
+static inline uint64_t packData(int score, int eval, Move bestMove, int depth, uint8_t flag, uint8_t gen) {
+    return  (uint64_t)bestMove
+         | ((uint64_t)(uint16_t)(int16_t)score << 16)
+         | ((uint64_t)(uint8_t)depth            << 32)
+         | ((uint64_t)(flag & 3)                << 40)
+         | ((uint64_t)(gen & TT_GEN_MASK)       << 42)
+         | ((uint64_t)(uint16_t)(int16_t)eval  << 48);
+}
+
+static inline Move    dataMove (uint64_t d) { return (Move)(d & 0xFFFF); }
+static inline int16_t dataScore(uint64_t d) { return (int16_t)(uint16_t)(d >> 16); }
+static inline int8_t  dataDepth(uint64_t d) { return (int8_t)(uint8_t)(d >> 32); }
+static inline uint8_t dataFlag (uint64_t d) { return (uint8_t)((d >> 40) & 3); }
+static inline uint8_t dataGen  (uint64_t d) { return (uint8_t)((d >> 42) & TT_GEN_MASK); }
+static inline int16_t dataEval (uint64_t d) { return (int16_t)(uint16_t)(d >> 48); }
+
+// ========================================================================
+//  Large-page allocation
+// ========================================================================
+constexpr size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+// Tries explicit huge pages first (Linux MAP_HUGETLB, fresh pages are
+// already zero), then falls back to 2MB-aligned memory advised for
+// transparent huge pages. Sets `mapped` when the memory must go to munmap.
+static void* allocLarge(size_t bytes, bool& mapped, bool& zeroed) {
+    mapped = false;
+    zeroed = false;
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    if (bytes % HUGE_PAGE == 0) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) { mapped = true; zeroed = true; return p; }
+    }
+#endif
+    size_t align = bytes >= HUGE_PAGE ? HUGE_PAGE : 64;
+    size_t rounded = (bytes + align - 1) / align * align;
+#if defined(_WIN32)
+    void* p = _aligned_malloc(rounded, align);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, align, rounded) != 0) p = nullptr;
+#endif
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (p) madvise(p, rounded, MADV_HUGEPAGE);
+#endif
+    return p;
+}
+
+static void freeLarge(void* p, size_t bytes, bool mapped) {
+    if (!p) return;
+#if defined(__linux__)
+    if (mapped) { munmap(p, bytes); return; }
+#endif
+    (void)bytes; (void)mapped;
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// ========================================================================
+//  Init / Destroy
+// ========================================================================
+// Buckets in a table of `mb` megabytes, rounded down to a power of 2
+static size_t bucketsFor(size_t mb) {
+    size_t n = mb * 1024ULL * 1024ULL / sizeof(TTBucket);
+    size_t p = 1;
+    while (p * 2 <= n) p *= 2;
+    return p;
+}
+
+void TranspositionTable::init(size_t mb) {
+    numBuckets = bucketsFor(mb);
+    bucketMask = numBuckets - 1;
+
+    bool zeroed = false;
+    buckets = (TTBucket*)allocLarge(numBuckets * sizeof(TTBucket), mapped, zeroed);
+    if (!buckets) {
+        // Out of memory: fall back to the smallest table rather than crash
+        numBuckets = 1;
+        bucketMask = 0;
+        buckets = (TTBucket*)allocLarge(sizeof(TTBucket), mapped, zeroed);
+    }
+    // The size we got, so that a later resize to the same value retries
+    sizeMB = numBuckets * sizeof(TTBucket) / (1024 * 1024);
+    if (zeroed) generation = 0;
+    else clear();
+}
+
+void TranspositionTable::destroy() {
+    freeLarge(buckets, numBuckets * sizeof(TTBucket), mapped);
+    buckets = nullptr;
+    numBuckets = 0;
+    sizeMB = 0;
+}
+
+void TranspositionTable::resize(size_t mb) {
+    if (buckets && sizeMB && bucketsFor(mb) == numBuckets) return;
+    destroy();
+    init(mb);
+}
+
+// Clearing is split across threads. Besides being faster for multi-GB
+// tables, each thread touching its own chunk first places those pages on
+// its NUMA node, spreading the table over the machine's memory controllers.
+void TranspositionTable::clear() {
+    size_t bytes = numBuckets * sizeof(TTBucket);
+    size_t nThreads = std::max(1u, std::thread::hardware_concurrency());
+    nThreads = std::min(nThreads, std::max<size_t>(1, bytes / (32 * 1024 * 1024)));
+
+    if (nThreads == 1) {
+        memset((void*)buckets, 0, bytes);
+    } else {
+        std::vector<std::thread> workers;
+        size_t chunk = (numBuckets + nThreads - 1) / nThreads;
+        for (size_t t = 0; t < nThreads; t++) {
+            size_t begin = t * chunk;
+            size_t end   = std::min(numBuckets, begin + chunk);
+            if (begin >= end) break;
+            workers.emplace_back([this, begin, end]() {
+                memset((void*)(buckets + begin), 0, (end - begin) * sizeof(TTBucket));
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    generation = 0;
+}
+
+// ========================================================================
+//  Probe / Store
+// ========================================================================
+bool TranspositionTable::probe(uint64_t key, TTEntry& out) const {
+    const TTBucket& b = buckets[key & bucketMask];
+    for (int i = 0; i < TT_BUCKET_SLOTS; i++) {
+        uint64_t d = b.slot[i].data.load(std::memory_order_relaxed);
+        uint64_t c = b.slot[i].check.load(std::memory_order_relaxed);
+        if ((c ^ d) != key || dataFlag(d) == TT_NONE) continue;
+        out.bestMove = dataMove(d);
+        out.score    = dataScore(d);
+        out.eval     = dataEval(d);
+        out.depth    = dataDepth(d);
+        out.flag     = dataFlag(d);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int eval, Move bestMove, int depth, uint8_t flag) {
+    TTBucket& b = buckets[key & bucketMask];
+
+    // Pick the slot: same position if present, else an empty one, else the
+    // slot with the lowest depth, where each generation of age costs 8 plies.
+    // Slots fill front to back, so the first empty slot ends the scan.
+    TTSlot* victim = &b.slot[0];
+    int victimValue = 1 << 30;
+    uint64_t old = 0;               // data of the same position, if found
+    for (int i = 0; i < TT_BUCKET_SLOTS; i++) {
+        TTSlot& s = b.slot[i];
+        uint64_t d = s.data.load(std::memory_order_relaxed);
+        uint64_t c = s.check.load(std::memory_order_relaxed);
+        if (dataFlag(d) == TT_NONE) {
+            victim = &s;
+            break;
+        }
+        if ((c ^ d) == key) {
+            victim = &s;
+            old = d;
+            break;
+        }
+        int age = (generation - dataGen(d)) & TT_GEN_MASK;
+        int value = dataDepth(d) - 8 * age;
+        if (value < victimValue) { victim = &s; victimValue = value; }
+    }
+
+    uint64_t d;
+    if (old && flag != TT_EXACT && depth < dataDepth(old) - TT_REPLACE_MARGIN
+            && dataGen(old) == generation) {
+        // A much shallower bound does not replace a deeper result of this
+        // search; only its move is taken over
+        if (bestMove == MOVE_NONE || bestMove == dataMove(old)) return;
+        d = (old & ~0xFFFFULL) | bestMove;
+    } else {
+        // Keep the old move / eval when the new result has none
+        if (old && bestMove == MOVE_NONE) bestMove = dataMove(old);
+        if (old && eval == EVAL_NONE)     eval = dataEval(old);
+        d = packData(score, eval, bestMove, depth, flag, generation);
+    }
+    victim->data.store(d, std::memory_order_relaxed);
+    victim->check.store(key ^ d, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    int used = 0;
+    size_t n = std::min<size_t>(numBuckets, 1000 / TT_BUCKET_SLOTS);
+    for (size_t i = 0; i < n; i++)
+        for (int j = 0; j < TT_BUCKET_SLOTS; j++) {
+            uint64_t d = buckets[i].slot[j].data.load(std::memory_order_relaxed);
+            if (dataFlag(d) != TT_NONE && dataGen(d) == generation) used++;
+        }
+    return (int)(used * 1000 / (n * TT_BUCKET_SLOTS));
+}
+
+// ========================================================================
+//  Save / Load
+// ========================================================================
+// File layout: TTFileHeader, then `entries` records of { key, data } with
+// data in the slot packing above. The Zobrist fingerprint rejects files
+// written by a build with other keys.
+constexpr char     TT_FILE_MAGIC[8]  = { 'J', 'U', 'N', 'G', 'L', 'E', 'T', 'T' };
+constexpr uint32_t TT_FILE_VERSION   = 1;
+
+struct TTFileHeader {
+    char     magic[8];
+    uint32_t version;
+    int32_t  minDepth;      // as saved, INT_MIN = every entry
+    uint64_t zobrist;       // zobristSide of the writing build
+    uint64_t entries;
+};
+
+int64_t TranspositionTable::save(const std::string& path, int minDepth, std::string& error) const {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) { error = "cannot write " + path; return -1; }
+
+    TTFileHeader h{};
+    memcpy(h.magic, TT_FILE_MAGIC, sizeof(h.magic));
+    h.version  = TT_FILE_VERSION;
+    h.minDepth = minDepth;
+    h.zobrist  = zobristSide;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+
+    // The table may be in use: a slot torn by a concurrent store yields a
+    // key no position has, which a probe never matches
+    std::vector<TTRecord> buf;
+    buf.reserve(1 << 16);
+    for (size_t i = 0; i < numBuckets && ok; i++) {
+        for (int j = 0; j < TT_BUCKET_SLOTS; j++) {
+            const TTSlot& s = buckets[i].slot[j];
+            uint64_t d = s.data.load(std::memory_order_relaxed);
+            uint64_t c = s.check.load(std::memory_order_relaxed);
+            if (dataFlag(d) == TT_NONE || dataDepth(d) < minDepth) continue;
+            buf.push_back({ c ^ d, d });
+        }
+        if (buf.size() + TT_BUCKET_SLOTS > buf.capacity() || i + 1 == numBuckets) {
+            ok = std::fwrite(buf.data(), sizeof(TTRecord), buf.size(), f) == buf.size();
+            h.entries += buf.size();
+            buf.clear();
+        }
+    }
+
+    // Entry count last, so an interrupted save is rejected on load
+    ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) { error = "write failed: " + path; return -1; }
+    return (int64_t)h.entries;
+}
+
+int64_t TranspositionTable::load(const std::string& path, std::string& error) {
+    MappedFile file;
+    if (!file.open(path)) { error = "cannot read " + path; return -1; }
+
+    TTFileHeader h;
+    if (file.size < sizeof(h)) { file.close(); error = path + " is not a hash file"; return -1; }
+    memcpy(&h, file.data, sizeof(h));
+    if (memcmp(h.magic, TT_FILE_MAGIC, sizeof(h.magic)) != 0) error = path + " is not a hash file";
+    else if (h.version != TT_FILE_VERSION)                       error = path + ": unsupported version";
+    else if (h.zobrist != zobristSide)                         error = path + ": written with other hash keys";
+    // Checked without multiplying: a corrupt count must not wrap around
+    else if ((file.size - sizeof(h)) % sizeof(TTRecord) != 0
+             || h.entries != (file.size - sizeof(h)) / sizeof(TTRecord))
+        error = path + ": size does not match its entry count";
+    if (!error.empty()) { file.close(); return -1; }
+
+    importEntries((const TTRecord*)((const char*)file.data + sizeof(h)), (size_t)h.entries);
+    file.close();
+    return (int64_t)h.entries;
+}
+
+// Records keep their packed data; only the generation becomes ours
+void TranspositionTable::importEntries(const TTRecord* records, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint64_t d = records[i].data;
+        if (dataFlag(d) == TT_NONE) continue;
+        store(records[i].key, dataScore(d), dataEval(d), dataMove(d), dataDepth(d), dataFlag(d));
+    }
+}
+
+// One call scans at most the whole table, starting at `cursor`; the next
+// call resumes after the last bucket scanned
+void TranspositionTable::exportEntries(int minDepth, size_t limit, size_t& cursor,
+                                       std::vector<TTRecord>& out) const {
+    for (size_t n = 0; n < numBuckets && out.size() < limit; n++) {
+        size_t i = cursor++ & bucketMask;
+        for (int j = 0; j < TT_BUCKET_SLOTS; j++) {
+            const TTSlot& s = buckets[i].slot[j];
+            uint64_t d = s.data.load(std::memory_order_relaxed);
+            uint64_t c = s.check.load(std::memory_order_relaxed);
+            if (dataFlag(d) != TT_NONE && dataGen(d) == generation && dataDepth(d) >= minDepth)
+                out.push_back({ c ^ d, d });
+        }
+    }
+    cursor &= bucketMask;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "types.h"
+#include <atomic>
+#include <climits>
+#include <string>
+#include <vector>
+
+// ---- Transposition Table ----
+constexpr uint8_t TT_NONE  = 0;
+constexpr uint8_t TT_EXACT = 1;
+constexpr uint8_t TT_ALPHA = 2; // upper bound (fail-low)
+constexpr uint8_t TT_BETA  = 3; // lower bound (fail-high)
+
+// Decoded entry, as returned by probe()
+struct TTEntry {
+    int16_t  score;
+    int16_t  eval;      // static eval of the position, EVAL_NONE if unknown
+    Move     bestMove;
+    int8_t   depth;
+    uint8_t  flag;
+};
+
+constexpr int EVAL_NONE = -32768;
+
+// Packed slot. `check` holds key ^ data, so a slot torn by two threads
+// writing at once fails verification on probe instead of returning
+// another position's data. No locks are needed.
+//   data bits  0-15 move, 16-31 score, 32-39 depth, 40-41 flag, 42-47 generation,
+//              48-63 static eval
+struct TTSlot {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+};
+
+constexpr int TT_BUCKET_SLOTS = 4;
+constexpr int TT_GEN_BITS     = 6;
+constexpr int TT_GEN_MASK     = (1 << TT_GEN_BITS) - 1;
+// A same-position store replaces a non-exact entry of the current
+// generation only if it is at most this many plies shallower
+constexpr int TT_REPLACE_MARGIN = 4;
+
+// One cache line per bucket
+struct alignas(64) TTBucket {
+    TTSlot slot[TT_BUCKET_SLOTS];
+};
+
+// A used slot outside the table: key and packed data (saved tables,
+// entries shared between machines)
+struct TTRecord {
+    uint64_t key;
+    uint64_t data;
+};
+
+class TranspositionTable {
+public:
+    void init(size_t sizeMB);
+    void destroy();
+    void resize(size_t sizeMB);     // reallocates only if the size changes
+    void clear();                   // zeroes the table in parallel
+    // Megabytes allocated: a power of 2 at most the requested size, 0 if
+    // only the single-bucket fallback could be allocated
+    size_t sizeInMB() const { return sizeMB; }
+
+    // Called once per root search: entries from older searches age out
+    void newSearch() { generation = (uint8_t)((generation + 1) & TT_GEN_MASK); }
+
+    bool probe(uint64_t key, TTEntry& out) const;
+    void store(uint64_t key, int score, int eval, Move bestMove, int depth, uint8_t flag);
+
+    // Per-mille of sampled slots written during the current search
+    int  hashfull() const;
+
+    // Persistent store: the used slots of depth >= minDepth as (key, data)
+    // records behind a versioned header. Loading re-inserts them into the
+    // current table (any size) as entries of this search generation.
+    // Both return the number of entries, or -1 with `error` set.
+    int64_t save(const std::string& path, int minDepth, std::string& error) const;
+    int64_t load(const std::string& path, std::string& error);
+
+    // Entries of depth >= minDepth written in the current search (at most
+    // `limit` of them, from bucket `cursor` on, which is advanced so that
+    // repeated calls cycle through the table), and their re-insertion
+    void exportEntries(int minDepth, size_t limit, size_t& cursor, std::vector<TTRecord>& out) const;
+    void importEntries(const TTRecord* records, size_t count);
+
+private:
+    TTBucket* buckets    = nullptr;
+    size_t    numBuckets = 0;
+    size_t    bucketMask = 0;
+    size_t    sizeMB     = 0;
+    bool      mapped     = false;   // buckets came from mmap (not aligned alloc)
+    uint8_t   generation = 0;
+};
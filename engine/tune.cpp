@@ -0,0 +1,322 @@
+// jungle-tune: Texel tuning of the handcrafted eval weights (evalparams.h)
+//
+//   jungle-tune <data.bin> [epochs <n>] [threads <t>] [lr <x>] [lambda <x>]
+//               [refresh <n>] [limit <n>] [out <file>]
+//
+// Loads self-play records (selfplay.h), resolves each position with a
+// capture-only quiescence search and fits the weights so that
+// sigmoid(K * eval / 400) predicts the target: the game result, blended
+// with the recorded search score by (1 - lambda). The eval is linear in
+// the weights, so each quiescence leaf is reduced once to its coefficient
+// vector (Board::evalTrace) and every epoch is a dot product and a
+// gradient per position, split over threads, followed by an Adam step.
+// Every `refresh` epochs the rounded weights are installed, the leaves
+// recomputed and the header written.
+#include "selfplay.h"
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+constexpr int QS_MAX_PLY = 16;
+
+struct TuneOptions {
+    std::string data;
+    std::string out     = "evalweights_tuned.h";
+    int     epochs      = 500;
+    int     threads     = 1;
+    double  lr          = 1.0;      // Adam step, centipawns
+    double  lambda      = 1.0;      // weight of the game result in the target
+    int     refresh     = 50;       // epochs between quiescence refreshes
+    int64_t limit       = 0;        // positions, 0 = all
+};
+
+// Runs `fn(begin, end, thread)` over [0, n) split into `threads` chunks
+template <typename Fn>
+static void parallelFor(int64_t n, int threads, Fn&& fn) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        int64_t begin = n * t / threads, end = n * (t + 1) / threads;
+        workers.emplace_back([&fn, begin, end, t]() { fn(begin, end, t); });
+    }
+    for (auto& w : workers) w.join();
+}
+
+static int64_t msSince(std::chrono::steady_clock::time_point t0) {
+    auto t = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t - t0).count();
+}
+
+// ========================================================================
+//  Quiescence
+// ========================================================================
+// Captures only, MVV-LVA order. Fills the principal variation.
+static int qsearch(Board& b, int alpha, int beta, int ply, Move* pv, int& pvLen) {
+    pvLen = 0;
+    int over = b.checkGameOver();
+    if (over != 0) return over * (SCORE_MATE - ply);
+
+    int standPat = b.evaluate();
+    if (standPat >= beta || ply >= QS_MAX_PLY) return standPat;
+    alpha = std::max(alpha, standPat);
+
+    Move moves[MAX_MOVES];
+    int count = 0;
+    b.generateCaptures(moves, count);
+    int keys[MAX_MOVES];
+    for (int i = 0; i < count; i++)
+        keys[i] = MATERIAL_VAL[abs(b.squares[moveTo(moves[i])])] * 16
+                - MATERIAL_VAL[abs(b.squares[moveFrom(moves[i])])] / 64;
+
+    Move childPv[QS_MAX_PLY + 1];
+    int  childLen;
+    for (int i = 0; i < count; i++) {
+        int best = i;
+        for (int j = i + 1; j < count; j++)
+            if (keys[j] > keys[best]) best = j;
+        std::swap(moves[i], moves[best]);
+        std::swap(keys[i], keys[best]);
+
+        b.makeMove(moves[i]);
+        int score = -qsearch(b, -beta, -alpha, ply + 1, childPv, childLen);
+        b.unmakeMove();
+        if (score > alpha) {
+            alpha = score;
+            pv[0] = moves[i];
+            memcpy(pv + 1, childPv, sizeof(Move) * childLen);
+            pvLen = childLen + 1;
+            if (score >= beta) break;
+        }
+    }
+    return alpha;
+}
+
+// ========================================================================
+//  Dataset
+// ========================================================================
+struct TuneSet {
+    std::vector<PackedPos> positions;
+    std::vector<double>    target;      // expected score for the side to move
+    std::vector<int8_t>    coef;        // NUM_EVAL_PARAMS per position, root side
+};
+
+static double sigmoid(double k, double eval) {
+    return 1.0 / (1.0 + std::exp(-k * eval / 400.0));
+}
+
+static bool loadData(const TuneOptions& opt, TuneSet& set) {
+    FILE* f = std::fopen(opt.data.c_str(), "rb");
+    if (!f) {
+        std::printf("cannot open %s\n", opt.data.c_str());
+        return false;
+    }
+    PackedPos buf[1024];
+    size_t n;
+    while ((n = std::fread(buf, sizeof(PackedPos), 1024, f)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (buf[i].result < -1 || buf[i].result > 1) continue;
+            set.positions.push_back(buf[i]);
+        }
+        if (opt.limit > 0 && (int64_t)set.positions.size() >= opt.limit) break;
+    }
+    std::fclose(f);
+    if (opt.limit > 0 && (int64_t)set.positions.size() > opt.limit)
+        set.positions.resize((size_t)opt.limit);
+    return !set.positions.empty();
+}
+
+// Quiescence leaf of every position under the current weights, reduced to
+// its coefficients. Returns the number of leaves whose trace does not
+// reproduce evaluate() (should be 0).
+static int64_t computeTraces(TuneSet& set, int threads) {
+    int64_t n = (int64_t)set.positions.size();
+    set.coef.assign((size_t)n * NUM_EVAL_PARAMS, 0);
+    std::vector<int64_t> bad(threads, 0);
+
+    parallelFor(n, threads, [&](int64_t begin, int64_t end, int t) {
+        std::unique_ptr<Board> b(new Board());
+        int coef[NUM_EVAL_PARAMS];
+        Move pv[QS_MAX_PLY + 1];
+        for (int64_t i = begin; i < end; i++) {
+            if (!unpackPosition(set.positions[i], *b)) { bad[t]++; continue; }
+            int pvLen;
+            qsearch(*b, -SCORE_INF, SCORE_INF, 0, pv, pvLen);
+
+            // Play out the PV; a leaf that ends the game has no eval to fit
+            int played = 0;
+            while (played < pvLen) {
+                b->makeMove(pv[played++]);
+                if (b->checkGameOver() != 0) break;
+            }
+            if (b->checkGameOver() != 0)
+                while (played > 0) { b->unmakeMove(); played--; }
+
+            b->evalTrace(coef);
+            int64_t dot = 0;
+            for (int j = 0; j < NUM_EVAL_PARAMS; j++) dot += (int64_t)coef[j] * evalParams[j];
+            if (dot != b->evaluate()) bad[t]++;
+
+            int sign = (played & 1) ? -1 : 1;       // back to the root side
+            int8_t* c = &set.coef[(size_t)i * NUM_EVAL_PARAMS];
+            for (int j = 0; j < NUM_EVAL_PARAMS; j++) c[j] = (int8_t)(sign * coef[j]);
+        }
+    });
+
+    int64_t total = 0;
+    for (int64_t x : bad) total += x;
+    return total;
+}
+
+// Mean squared error and, if `grad` is given, its gradient
+static double evalError(const TuneSet& set, const std::vector<double>& params, double k,
+                        int threads, std::vector<double>* grad) {
+    int64_t n = (int64_t)set.positions.size();
+    std::vector<double> err(threads, 0.0);
+    std::vector<std::vector<double>> part(threads, std::vector<double>(grad ? NUM_EVAL_PARAMS : 0, 0.0));
+
+    parallelFor(n, threads, [&](int64_t begin, int64_t end, int t) {
+        double e = 0;
+        std::vector<double>& g = part[t];
+        for (int64_t i = begin; i < end; i++) {
+            const int8_t* c = &set.coef[(size_t)i * NUM_EVAL_PARAMS];
+            double eval = 0;
+            for (int j = 0; j < NUM_EVAL_PARAMS; j++) eval += c[j] * params[j];
+            double s = sigmoid(k, eval);
+            double diff = set.target[i] - s;
+            e += diff * diff;
+            if (grad) {
+                double d = -2.0 * diff * s * (1.0 - s) * k / 400.0;
+                for (int j = 0; j < NUM_EVAL_PARAMS; j++)
+                    if (c[j]) g[j] += d * c[j];
+            }
+        }
+        err[t] = e;
+    });
+
+    double total = 0;
+    for (double e : err) total += e;
+    if (grad) {
+        grad->assign(NUM_EVAL_PARAMS, 0.0);
+        for (auto& g : part)
+            for (int j = 0; j < NUM_EVAL_PARAMS; j++) (*grad)[j] += g[j] / n;
+    }
+    return total / n;
+}
+
+// K minimising the error of the current weights (golden section search)
+static double fitK(const TuneSet& set, const std::vector<double>& params, int threads) {
+    double lo = 0.05, hi = 10.0;
+    const double phi = 0.6180339887;
+    for (int it = 0; it < 40; it++) {
+        double a = hi - phi * (hi - lo), b = lo + phi * (hi - lo);
+        if (evalError(set, params, a, threads, nullptr) < evalError(set, params, b, threads, nullptr))
+            hi = b;
+        else
+            lo = a;
+    }
+    return (lo + hi) / 2;
+}
+
+// ========================================================================
+//  Output
+// ========================================================================
+static bool writeHeader(const std::string& path, const int* params) {
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "#pragma once\n#include \"evalparams.h\"\n\n");
+    std::fprintf(f, "// Handcrafted eval weights, indexed by EvalParam. Written by jungle-tune.\n");
+    std::fprintf(f, "constexpr int DEFAULT_EVAL_PARAMS[NUM_EVAL_PARAMS] = {\n");
+    for (int g = 0; g < NUM_EVAL_PARAM_GROUPS; g++) {
+        const EvalParamGroup& grp = EVAL_PARAM_GROUPS[g];
+        std::fprintf(f, "    // %s\n   ", grp.name);
+        for (int i = 0; i < grp.count; i++) std::fprintf(f, " %d,", params[grp.index + i]);
+        std::fprintf(f, "\n");
+    }
+    std::fprintf(f, "};\n");
+    std::fclose(f);
+    return true;
+}
+
+// ========================================================================
+//  Main
+// ========================================================================
+int main(int argc, char* argv[]) {
+    TuneOptions opt;
+    opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a.compare(0, 2, "--") == 0) a = a.substr(2);
+        bool hasValue = i + 1 < argc;
+        if (a == "epochs" && hasValue)       opt.epochs  = std::atoi(argv[++i]);
+        else if (a == "threads" && hasValue) opt.threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "lr" && hasValue)      opt.lr      = std::atof(argv[++i]);
+        else if (a == "lambda" && hasValue)  opt.lambda  = std::atof(argv[++i]);
+        else if (a == "refresh" && hasValue) opt.refresh = std::max(1, std::atoi(argv[++i]));
+        else if (a == "limit" && hasValue)   opt.limit   = std::atoll(argv[++i]);
+        else if (a == "out" && hasValue)     opt.out     = argv[++i];
+        else                                 opt.data    = a;
+    }
+    if (opt.data.empty()) {
+        std::printf("usage: jungle-tune <data.bin> [epochs <n>] [threads <t>] [lr <x>] [lambda <x>]\n"
+                    "                   [refresh <n>] [limit <n>] [out <file>]\n");
+        return 1;
+    }
+
+    TuneSet set;
+    if (!loadData(opt, set)) return 1;
+    int64_t n = (int64_t)set.positions.size();
+
+    auto t0 = std::chrono::steady_clock::now();
+    int64_t bad = computeTraces(set, opt.threads);
+    int64_t ms = msSince(t0);
+    std::printf("positions %lld, traced in %lld ms (%lld pos/s), %lld trace mismatches\n",
+                (long long)n, (long long)ms, (long long)(n * 1000 / std::max<int64_t>(ms, 1)),
+                (long long)bad);
+
+    std::vector<double> params(evalParams, evalParams + NUM_EVAL_PARAMS);
+
+    // Targets: the result, blended with the search score under the fitted K
+    set.target.resize(n);
+    for (int64_t i = 0; i < n; i++) set.target[i] = (set.positions[i].result + 1) * 0.5;
+    double k = fitK(set, params, opt.threads);
+    if (opt.lambda < 1.0) {
+        for (int64_t i = 0; i < n; i++)
+            set.target[i] = opt.lambda * set.target[i]
+                          + (1.0 - opt.lambda) * sigmoid(k, set.positions[i].score);
+        k = fitK(set, params, opt.threads);
+    }
+    std::printf("K = %.4f, initial error %.6f\n", k, evalError(set, params, k, opt.threads, nullptr));
+    fflush(stdout);
+
+    // Adam
+    const double beta1 = 0.9, beta2 = 0.999, eps = 1e-8;
+    std::vector<double> m(NUM_EVAL_PARAMS, 0.0), v(NUM_EVAL_PARAMS, 0.0), grad;
+    int rounded[NUM_EVAL_PARAMS];
+    t0 = std::chrono::steady_clock::now();
+
+    for (int epoch = 1; epoch <= opt.epochs; epoch++) {
+        double e = evalError(set, params, k, opt.threads, &grad);
+        for (int j = 0; j < NUM_EVAL_PARAMS; j++) {
+            m[j] = beta1 * m[j] + (1 - beta1) * grad[j];
+            v[j] = beta2 * v[j] + (1 - beta2) * grad[j] * grad[j];
+            double mh = m[j] / (1 - std::pow(beta1, epoch));
+            double vh = v[j] / (1 - std::pow(beta2, epoch));
+            params[j] -= opt.lr * mh / (std::sqrt(vh) + eps);
+        }
+
+        if (epoch % opt.refresh == 0 || epoch == opt.epochs) {
+            for (int j = 0; j < NUM_EVAL_PARAMS; j++) rounded[j] = (int)std::lround(params[j]);
+            setEvalParams(rounded);
+            computeTraces(set, opt.threads);
+            for (int j = 0; j < NUM_EVAL_PARAMS; j++) params[j] = rounded[j];
+            writeHeader(opt.out, rounded);
+            ms = msSince(t0);
+            std::printf("epoch %d  error %.6f  %lld ms  (%lld pos/s)  -> %s\n", epoch, e,
+                        (long long)ms, (long long)((double)n * epoch * 1000 / std::max<int64_t>(ms, 1)),
+                        opt.out.c_str());
+            fflush(stdout);
+        }
+    }
+
+    std::printf("final error %.6f\n", evalError(set, params, k, opt.threads, nullptr));
+    return 0;
+}
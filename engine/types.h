@@ -12,8 +12,8 @@ constexpr int BOARD_H = 9;
 constexpr int NUM_SQ  = 63;
 
 // Square index = row * 7 + col.  row 0 = rank "1" (bottom), col 0 = file 'a' (left).
-inline int sqRow(int sq) { return sq / BOARD_W; }
-inline int sqCol(int sq) { return sq % BOARD_W; }
+constexpr int sqRow(int sq) { return sq / BOARD_W; }
+constexpr int sqCol(int sq) { return sq % BOARD_W; }
 constexpr int makeSq(int r, int c) { return r * BOARD_W + c; }
 
 // ---- Piece Ranks (1-8, 0 = none) ----
@@ -44,6 +44,15 @@ constexpr int TERRAIN_DEN_DARK   = 5; // D9
 constexpr int DEN_LIGHT_SQ = makeSq(0, 3); // D1 = 3
 constexpr int DEN_DARK_SQ  = makeSq(8, 3); // D9 = 59
 
+// ---- Bitboards: bit sq set <=> square sq (63 squares fit in a uint64_t) ----
+using Bitboard = uint64_t;
+constexpr Bitboard ALL_SQ_BB = (1ULL << NUM_SQ) - 1;
+
+constexpr Bitboard sqBB(int sq) { return 1ULL << sq; }
+constexpr int lsb(Bitboard b)      { return __builtin_ctzll(b); }
+constexpr int popLSB(Bitboard& b)  { int sq = lsb(b); b &= b - 1; return sq; }
+constexpr int popcount(Bitboard b) { return __builtin_popcountll(b); }
+
 // ---- Directions ----
 constexpr int DIR_N =  7;
 constexpr int DIR_S = -7;
@@ -55,9 +64,9 @@ constexpr int DIRS[4] = { DIR_N, DIR_S, DIR_E, DIR_W };
 using Move = uint16_t;
 constexpr Move MOVE_NONE = 0xFFFF;
 
-inline int  moveFrom(Move m) { return m & 0x3F; }
-inline int  moveTo  (Move m) { return (m >> 6) & 0x3F; }
-inline Move encodeMove(int from, int to) { return (uint16_t)(from | (to << 6)); }
+constexpr int  moveFrom(Move m) { return m & 0x3F; }
+constexpr int  moveTo  (Move m) { return (m >> 6) & 0x3F; }
+constexpr Move encodeMove(int from, int to) { return (uint16_t)(from | (to << 6)); }
 
 // ---- Score constants ----
 constexpr int SCORE_INF   = 30000;
@@ -105,37 +114,7 @@ inline char pieceChar(int rank, int color) {
     return color == DARK ? (char)tolower(c) : c;
 }
 
-// ---- Global tables (initialised once) ----
-extern int  terrain[NUM_SQ];
-extern bool isWater[NUM_SQ];
-extern int  distLand[2][NUM_SQ];   // [den_side][sq] shortest distance on land
-extern int  distJumper[2][NUM_SQ]; // [den_side][sq] shortest distance with jumps
-extern int  distSwimmer[2][NUM_SQ];// [den_side][sq] shortest distance through water
-
-// Jump table for lion/tiger
-struct JumpEntry {
-    int from, to;
-    int blocking[3];   // water squares to check for rats
-    int numBlocking;
-};
-constexpr int MAX_JUMPS = 40;
-extern JumpEntry jumpTable[MAX_JUMPS];
-extern int numJumps;
-
-// Jump lookup per square
-constexpr int MAX_JUMPS_PER_SQ = 4;
-struct SqJumps {
-    int dest[MAX_JUMPS_PER_SQ];
-    int blockStart[MAX_JUMPS_PER_SQ]; // index into blocking squares
-    int blockCount[MAX_JUMPS_PER_SQ];
-    int blockingSqs[MAX_JUMPS_PER_SQ * 3]; // flattened
-    int count;
-};
-extern SqJumps sqJumpLookup[NUM_SQ];
-
-// Zobrist keys
-extern uint64_t zobristPiece[NUM_SQ][NUM_PIECE_TYPES][2]; // [sq][rank][color]
-extern uint64_t zobristSide;
+// Board tables (terrain, jumps, masks, Zobrist keys, distances): tables.h
 
 // Material values (index = rank)
 constexpr int MATERIAL_VAL[9] = {
@@ -150,11 +129,8 @@ constexpr int MATERIAL_VAL[9] = {
     1000   // ELEPHANT - strongest rank but vulnerable to rat
 };
 
-// Initialise all global tables
-void initTables();
-
 // Direction validity
-inline bool canStep(int from, int dir) {
+constexpr bool canStep(int from, int dir) {
     int to = from + dir;
     if (to < 0 || to >= NUM_SQ) return false;
     if (dir == DIR_E && sqCol(from) == BOARD_W - 1) return false;
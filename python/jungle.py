@@ -0,0 +1,324 @@
+"""
+Jungle Chess engine bindings: Board and Search over the C API of
+engine/libjungle.so (`cd engine && make lib`), loaded with ctypes.
+
+    import jungle
+    b = jungle.Board()
+    for m in b.moves(): ...
+    b.make_move("a3a4")
+    s = jungle.Search(hash_mb=64, threads=2)
+    s.set_position(b)
+    s.start(movetime=1000, on_info=print, on_done=lambda best, ponder, score: ...)
+    best = s.wait()
+
+Moves are strings ("a3a4") at this level; Board.moves_raw() gives the
+engine's 16-bit codes for bulk work. The library is looked up in
+$JUNGLE_LIB, then next to this file and in ../engine.
+"""
+
+import ctypes
+import os
+import sys
+
+MOVE_NONE = 0xFFFF
+MAX_MOVES = 80
+SCORE_MATE = 29000
+MAX_PLY = 128
+LIGHT, DARK = 0, 1
+
+
+def _load():
+    names = {"win32": ["jungle.dll"], "darwin": ["libjungle.dylib", "libjungle.so"]}
+    names = names.get(sys.platform, ["libjungle.so"])
+    here = os.path.dirname(os.path.abspath(__file__))
+    paths = [os.environ["JUNGLE_LIB"]] if os.environ.get("JUNGLE_LIB") else []
+    for d in (here, os.path.join(here, "..", "engine")):
+        paths += [os.path.join(d, n) for n in names]
+    for p in paths:
+        if os.path.isfile(p):
+            return ctypes.CDLL(p)
+    raise OSError("libjungle not found (build it with: cd engine && make lib)")
+
+
+class Limits(ctypes.Structure):
+    _fields_ = [
+        ("depth", ctypes.c_int),
+        ("movetime", ctypes.c_int64),
+        ("nodes", ctypes.c_int64),
+        ("time", ctypes.c_int64 * 2),
+        ("inc", ctypes.c_int64 * 2),
+        ("movestogo", ctypes.c_int),
+        ("infinite", ctypes.c_int),
+        ("searchmoves", ctypes.POINTER(ctypes.c_uint16)),
+        ("num_searchmoves", ctypes.c_int),
+    ]
+
+
+class _Info(ctypes.Structure):
+    _fields_ = [
+        ("depth", ctypes.c_int),
+        ("seldepth", ctypes.c_int),
+        ("multipv", ctypes.c_int),
+        ("score", ctypes.c_int),
+        ("nodes", ctypes.c_int64),
+        ("time_ms", ctypes.c_int64),
+        ("hashfull", ctypes.c_int),
+        ("pv_len", ctypes.c_int),
+        ("pv", ctypes.POINTER(ctypes.c_uint16)),
+    ]
+
+
+_INFO_FN = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(_Info))
+_DONE_FN = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_uint16, ctypes.c_uint16, ctypes.c_int)
+
+_lib = _load()
+
+
+def _sig(name, res, *args):
+    f = getattr(_lib, name)
+    f.restype = res
+    f.argtypes = list(args)
+
+
+_B, _S = ctypes.c_void_p, ctypes.c_void_p
+_u16, _int, _i64 = ctypes.c_uint16, ctypes.c_int, ctypes.c_int64
+_sig("jungle_api_version", _int)
+_sig("jungle_load_eval_file", _int, ctypes.c_char_p)
+_sig("jungle_load_tablebases", _int, ctypes.c_char_p)
+_sig("jungle_board_new", _B)
+_sig("jungle_board_clone", _B, _B)
+_sig("jungle_board_free", None, _B)
+_sig("jungle_board_startpos", None, _B)
+_sig("jungle_board_set_fen", _int, _B, ctypes.c_char_p)
+_sig("jungle_board_fen", _int, _B, ctypes.c_char_p, _int)
+_sig("jungle_board_side_to_move", _int, _B)
+_sig("jungle_board_piece", _int, _B, _int)
+_sig("jungle_board_ply", _int, _B)
+_sig("jungle_board_hash", ctypes.c_uint64, _B)
+_sig("jungle_board_moves", _int, _B, ctypes.POINTER(_u16), _int)
+_sig("jungle_board_make_move", _int, _B, _u16)
+_sig("jungle_board_unmake_move", _int, _B)
+_sig("jungle_board_evaluate", _int, _B)
+_sig("jungle_board_game_over", _int, _B)
+_sig("jungle_board_is_repetition", _int, _B)
+_sig("jungle_move_parse", _u16, ctypes.c_char_p)
+_sig("jungle_search_new", _S, _int, _int)
+_sig("jungle_search_free", None, _S)
+_sig("jungle_search_set_position", None, _S, _B)
+_sig("jungle_search_new_game", None, _S)
+_sig("jungle_search_set_hash", None, _S, _int)
+_sig("jungle_search_set_threads", None, _S, _int)
+_sig("jungle_search_set_multipv", None, _S, _int)
+_sig("jungle_search_start", _int, _S, ctypes.POINTER(Limits), _INFO_FN, _DONE_FN, ctypes.c_void_p)
+_sig("jungle_search_stop", None, _S)
+_sig("jungle_search_running", _int, _S)
+_sig("jungle_search_wait", _u16, _S)
+_sig("jungle_search_ponder_move", _u16, _S)
+_sig("jungle_search_score", _int, _S)
+_sig("jungle_search_nodes", _i64, _S)
+
+if _lib.jungle_api_version() != 1:
+    raise OSError("libjungle API version %d, expected 1" % _lib.jungle_api_version())
+
+
+# ---- Moves and squares ----
+def sq_name(sq):
+    return chr(ord("a") + sq % 7) + str(sq // 7 + 1)
+
+
+def move_str(m):
+    if m == MOVE_NONE:
+        return "0000"
+    return sq_name(m & 0x3F) + sq_name((m >> 6) & 0x3F)
+
+
+def move_code(s):
+    """'a3a4' -> 16-bit move; ints pass through."""
+    if isinstance(s, int):
+        return s
+    return _lib.jungle_move_parse(s.encode())
+
+
+def _global_result(r):
+    if r < 0:
+        raise RuntimeError("a search is running")
+    return r
+
+
+def load_eval_file(path):
+    """NNUE network for all boards and searches ("" = handcrafted eval).
+    Raises RuntimeError while any search is running."""
+    return bool(_global_result(_lib.jungle_load_eval_file((path or "").encode())))
+
+
+def load_tablebases(directory):
+    """Endgame tablebases from a directory ("" = unload); number of files.
+    Raises RuntimeError while any search is running."""
+    return _global_result(_lib.jungle_load_tablebases((directory or "").encode()))
+
+
+# ---- Board ----
+class Board:
+    def __init__(self, fen=None):
+        self._h = _lib.jungle_board_new()
+        self._buf = (_u16 * MAX_MOVES)()
+        if fen is not None:
+            self.set_fen(fen)
+
+    def __del__(self):
+        if getattr(self, "_h", None):
+            _lib.jungle_board_free(self._h)
+            self._h = None
+
+    def copy(self):
+        b = Board.__new__(Board)
+        b._h = _lib.jungle_board_clone(self._h)
+        b._buf = (_u16 * MAX_MOVES)()
+        return b
+
+    def reset(self):
+        _lib.jungle_board_startpos(self._h)
+
+    def set_fen(self, fen):
+        if not _lib.jungle_board_set_fen(self._h, fen.encode()):
+            raise ValueError("bad FEN: " + fen)
+
+    def fen(self):
+        buf = ctypes.create_string_buffer(128)
+        _lib.jungle_board_fen(self._h, buf, len(buf))
+        return buf.value.decode()
+
+    @property
+    def side_to_move(self):
+        return _lib.jungle_board_side_to_move(self._h)
+
+    @property
+    def ply(self):
+        return _lib.jungle_board_ply(self._h)
+
+    @property
+    def hash(self):
+        return _lib.jungle_board_hash(self._h)
+
+    def piece(self, sq):
+        """+rank (1 = rat .. 8 = elephant) for Light, -rank for Dark, 0."""
+        return _lib.jungle_board_piece(self._h, sq)
+
+    def moves_raw(self):
+        n = _lib.jungle_board_moves(self._h, self._buf, MAX_MOVES)
+        return self._buf[:n]
+
+    def moves(self):
+        return [move_str(m) for m in self.moves_raw()]
+
+    def make_move(self, move):
+        """Plays a move ("a3a4" or code); ValueError if it is illegal."""
+        if not _lib.jungle_board_make_move(self._h, move_code(move)):
+            raise ValueError("illegal move: %s" % (move if isinstance(move, str) else move_str(move)))
+
+    def unmake_move(self):
+        if not _lib.jungle_board_unmake_move(self._h):
+            raise IndexError("no move to unmake")
+
+    def evaluate(self):
+        """Static eval in centipawns, side to move's view."""
+        return _lib.jungle_board_evaluate(self._h)
+
+    def game_over(self):
+        """0 = game on, -1 = the side to move has lost, 1 = it has won."""
+        return _lib.jungle_board_game_over(self._h)
+
+    def is_repetition(self):
+        return bool(_lib.jungle_board_is_repetition(self._h))
+
+
+# ---- Search ----
+class Info:
+    """One root line after an iteration; pv as move strings."""
+    __slots__ = ("depth", "seldepth", "multipv", "score", "nodes", "time_ms", "hashfull", "pv")
+
+    def __init__(self, i):
+        self.depth, self.seldepth, self.multipv = i.depth, i.seldepth, i.multipv
+        self.score, self.nodes, self.time_ms, self.hashfull = i.score, i.nodes, i.time_ms, i.hashfull
+        self.pv = [move_str(i.pv[k]) for k in range(i.pv_len)]
+
+    @property
+    def mate(self):
+        """Moves to mate (negative: being mated), or None."""
+        if abs(self.score) < SCORE_MATE - MAX_PLY:
+            return None
+        n = (SCORE_MATE - abs(self.score) + 1) // 2
+        return n if self.score > 0 else -n
+
+    def __repr__(self):
+        m = self.mate
+        score = "mate %d" % m if m is not None else "cp %d" % self.score
+        return "info depth %d seldepth %d score %s nodes %d time %d pv %s" % (
+            self.depth, self.seldepth, score, self.nodes, self.time_ms, " ".join(self.pv))
+
+
+class Search:
+    """A searcher with its own hash table and threads. start() returns at
+    once; on_info(Info) and on_done(best, ponder, score) run on the
+    search thread."""
+
+    def __init__(self, hash_mb=64, threads=1):
+        self._h = _lib.jungle_search_new(hash_mb, threads)
+        self._callbacks = None      # kept alive while the search may call them
+
+    def __del__(self):
+        if getattr(self, "_h", None):
+            _lib.jungle_search_free(self._h)
+            self._h = None
+
+    def set_position(self, board):
+        _lib.jungle_search_set_position(self._h, board._h)
+
+    def new_game(self):
+        _lib.jungle_search_new_game(self._h)
+
+    def set_hash(self, mb):
+        _lib.jungle_search_set_hash(self._h, mb)
+
+    def set_threads(self, n):
+        _lib.jungle_search_set_threads(self._h, n)
+
+    def set_multipv(self, n):
+        _lib.jungle_search_set_multipv(self._h, n)
+
+    def start(self, depth=0, movetime=0, nodes=0, wtime=0, btime=0, winc=0, binc=0,
+              movestogo=0, infinite=False, searchmoves=None, on_info=None, on_done=None):
+        lim = Limits(depth=depth, movetime=movetime, nodes=nodes, movestogo=movestogo,
+                     infinite=int(infinite))
+        lim.time[0], lim.time[1], lim.inc[0], lim.inc[1] = wtime, btime, winc, binc
+        if searchmoves:
+            codes = (_u16 * len(searchmoves))(*[move_code(m) for m in searchmoves])
+            lim.searchmoves, lim.num_searchmoves = codes, len(searchmoves)
+        if self.running:
+            raise RuntimeError("a search is already running")
+        info_fn = _INFO_FN(lambda user, i: on_info(Info(i.contents))) if on_info else _INFO_FN()
+        done_fn = (_DONE_FN(lambda user, best, ponder, score: on_done(move_str(best), move_str(ponder), score))
+                   if on_done else _DONE_FN())
+        self._callbacks = (info_fn, done_fn)
+        _lib.jungle_search_start(self._h, ctypes.byref(lim), info_fn, done_fn, None)
+
+    def stop(self):
+        _lib.jungle_search_stop(self._h)
+
+    @property
+    def running(self):
+        return bool(_lib.jungle_search_running(self._h))
+
+    def wait(self):
+        """Blocks until the search ends; the best move."""
+        return move_str(_lib.jungle_search_wait(self._h))
+
+    def think(self, **limits):
+        """Blocking search: (best, ponder, score)."""
+        self.start(**limits)
+        best = self.wait()
+        return best, move_str(_lib.jungle_search_ponder_move(self._h)), _lib.jungle_search_score(self._h)
+
+    @property
+    def nodes(self):
+        return _lib.jungle_search_nodes(self._h)
@@ -1,7 +1,9 @@
 #!/usr/bin/env python3
 """
 Jungle Chess (Dou Shou Qi) GUI
-Communicates with the JungleEngine binary via stdin/stdout pipe.
+Runs the engine in-process through python/jungle.py (engine/libjungle.so,
+`make lib`) when it is built, otherwise talks to the JungleEngine binary
+via stdin/stdout pipe.
 """
 
 import tkinter as tk
@@ -12,6 +14,12 @@ import os
 import sys
 import time
 
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "python"))
+try:
+    import jungle
+except (ImportError, OSError):
+    jungle = None   # no libjungle: use the engine binary
+
 # ---- Constants ----
 BOARD_COLS = 7
 BOARD_ROWS = 9
@@ -119,11 +127,18 @@ class EngineProcess:
             cmd = "position startpos"
         self.send(cmd)
 
-    def go(self, movetime_ms=3000, depth=0):
+    def go(self, movetime_ms=3000, depth=0, ponder=False):
+        """Start a search. With ponder=True the engine searches the
+        position until ponderhit() (then it plays on its own clock) or
+        stop_search()."""
+        prefix = "go ponder" if ponder else "go"
         if depth > 0:
-            self.send(f"go depth {depth}")
+            self.send(f"{prefix} depth {depth}")
         else:
-            self.send(f"go movetime {movetime_ms}")
+            self.send(f"{prefix} movetime {movetime_ms}")
+
+    def ponderhit(self):
+        self.send("ponderhit")
 
     def stop_search(self):
         self.send("stop")
@@ -135,9 +150,13 @@ class JungleGUI:
         self.root.title("Jungle Chess - Dou Shou Qi")
         self.root.resizable(False, False)
 
-        # Engine
-        self.engine = EngineProcess(engine_path)
-        self.engine.start()
+        # Engine: in-process bindings if available, else a subprocess
+        self.native = jungle is not None
+        if self.native:
+            self.search = jungle.Search(hash_mb=64)
+        else:
+            self.engine = EngineProcess(engine_path)
+            self.engine.start()
 
         # Game state
         self.board = [[0]*BOARD_COLS for _ in range(BOARD_ROWS)]
@@ -148,6 +167,7 @@ class JungleGUI:
         self.last_move = None  # ((from_r, from_c), (to_r, to_c))
         self.game_over = False
         self.engine_thinking = False
+        self.game_id = 0       # bumped by New Game: late engine moves are dropped
 
         # Settings
         self.player_light = "human"  # "human" or "engine"
@@ -397,22 +417,31 @@ class JungleGUI:
                 self.legal_targets = []
                 self._draw_board()
 
-    def _get_legal_targets(self, r, c):
-        """Get legal target squares for piece at (r,c) using the engine."""
-        # Ask engine for legal moves
+    def _native_board(self):
+        """The game so far as a bindings Board."""
+        b = jungle.Board()
+        for mv in self.moves_list:
+            b.make_move(mv)
+        return b
+
+    def _legal_moves(self):
+        if self.native:
+            return self._native_board().moves()
+        # Ask engine for legal moves: "Legal moves (N): a1a2 b3b4 ..."
         self.engine.set_position(self.moves_list)
         self.engine.send("moves")
         line = self.engine.read_line()
-        # Parse "Legal moves (N): a1a2 b3b4 ..."
+        return line.split(":", 1)[1].split() if ":" in line else []
+
+    def _get_legal_targets(self, r, c):
+        """Get legal target squares for piece at (r,c) using the engine."""
         targets = []
-        if ":" in line:
-            parts = line.split(":", 1)[1].strip().split()
-            from_str = sq_name(r, c)
-            for mv in parts:
-                if mv[:2] == from_str:
-                    tr = int(mv[3]) - 1
-                    tc = ord(mv[2]) - ord('a')
-                    targets.append((tr, tc))
+        from_str = sq_name(r, c)
+        for mv in self._legal_moves():
+            if mv[:2] == from_str:
+                tr = int(mv[3]) - 1
+                tc = ord(mv[2]) - ord('a')
+                targets.append((tr, tc))
         return targets
 
     def _make_ui_move(self, fr, fc, tr, tc):
@@ -484,12 +513,24 @@ class JungleGUI:
         self._draw_board()
         self.root.update()
 
-        def run():
-            try:
-                time_ms = int(float(self.time_var.get()) * 1000)
-            except ValueError:
-                time_ms = 3000
+        try:
+            time_ms = int(float(self.time_var.get()) * 1000)
+        except ValueError:
+            time_ms = 3000
+
+        game = self.game_id
+        if self.native:
+            # Callbacks come from the search thread: hand them to Tk
+            def on_info(i):
+                score = "mate %d" % i.mate if i.mate is not None else "cp %d" % i.score
+                self.root.after(0, lambda: self._show_info(i.depth, score, i.nodes))
+            self.search.set_position(self._native_board())
+            self.search.start(movetime=time_ms, on_info=on_info,
+                              on_done=lambda best, ponder, score:
+                                  self.root.after(0, lambda: self._apply_engine_move(best, game)))
+            return
 
+        def run():
             self.engine.set_position(self.moves_list)
             self.engine.go(movetime_ms=time_ms)
 
@@ -509,7 +550,7 @@ class JungleGUI:
                         best_move = parts[1]
                     break
 
-            self.root.after(0, lambda: self._apply_engine_move(best_move))
+            self.root.after(0, lambda: self._apply_engine_move(best_move, game))
 
         t = threading.Thread(target=run, daemon=True)
         t.start()
@@ -535,9 +576,9 @@ class JungleGUI:
             else:
                 i += 1
 
-        depth = info.get("depth", "?")
-        score = info.get("score", "?")
-        nodes = info.get("nodes", "?")
+        self._show_info(info.get("depth", "?"), info.get("score", "?"), info.get("nodes", "?"))
+
+    def _show_info(self, depth, score, nodes):
         try:
             n = int(nodes)
             if n > 1000000:
@@ -548,8 +589,10 @@ class JungleGUI:
             pass
         self.info_var.set(f"d={depth}  {score}  n={nodes}")
 
-    def _apply_engine_move(self, move_str):
-        """Apply the engine's move to the board."""
+    def _apply_engine_move(self, move_str, game):
+        """Apply the engine's move to the board (unless a new game started)."""
+        if game != self.game_id:
+            return
         self.engine_thinking = False
         if not move_str or move_str == "0000" or len(move_str) < 4:
             self.status_var.set("Engine returned no move!")
@@ -571,7 +614,15 @@ class JungleGUI:
         self.status_var.set(f"{who} to move {label}")
 
     def _new_game(self):
-        self.engine.send("newgame")
+        # A search still running belongs to the old game: end it at once
+        self.game_id += 1
+        self.engine_thinking = False
+        if self.native:
+            self.search.stop()
+            self.search.new_game()
+        else:
+            self.engine.send("stop")
+            self.engine.send("newgame")
         self._init_board()
         self._draw_board()
         self._update_status()
@@ -617,7 +668,11 @@ class JungleGUI:
         self._update_status()
 
     def _on_close(self):
-        self.engine.quit()
+        if self.native:
+            self.search.stop()
+            self.search.wait()
+        else:
+            self.engine.quit()
         self.root.destroy()
 
 
@@ -628,7 +683,7 @@ def main():
     if not os.path.isfile(engine_path):
         # Try current dir
         engine_path = os.path.join(script_dir, "jungle")
-    if not os.path.isfile(engine_path):
+    if not os.path.isfile(engine_path) and jungle is None:
         print(f"Error: engine binary not found at {engine_path}")
         print("Build the engine first: cd engine && make")
         sys.exit(1)